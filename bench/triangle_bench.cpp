@@ -0,0 +1,136 @@
+// Microbenchmark des tests d'intersection rayon-triangle.
+//
+// Compare le test géométrique d'origine (Mesh::intersect_triangle) au noyau Möller–Trumbore
+// sur les triangles prétraités (TriangleStore), un triangle à la fois puis par intervalle
+// (TriangleStore::intersect_range, AVX2 si disponible). Chaque rayon est testé contre tous les
+// triangles du maillage, sans BVH, afin de ne mesurer que le coût des tests.
+//
+// Usage: triangle_bench [fichier.obj] [nombre de rayons]
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+
+#include "cpu.h"
+#include "object.h"
+#include "scheduler.h"
+#include "pcg32/pcg32.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Donne accès au test géométrique d'origine.
+class BenchMesh : public Mesh {
+public:
+	BenchMesh(std::ifstream& file) : Mesh(file) {}
+	using Mesh::intersect_triangle;
+};
+
+// Point uniforme sur la sphère unité.
+double3 random_direction(pcg32& rng) {
+	double z = 2.0 * rng.nextDouble() - 1.0;
+	double phi = 2.0 * M_PI * rng.nextDouble();
+	double r = std::sqrt(std::max(0.0, 1.0 - z * z));
+	return double3{r * std::cos(phi), r * std::sin(phi), z};
+}
+
+}
+
+int main(int argc, char** argv) {
+	std::string filename = argc > 1 ? argv[1] : "data/assets/mesh/suzanne.obj";
+	int n_rays = argc > 2 ? std::atoi(argv[2]) : 2000;
+
+	std::ifstream file(filename.c_str());
+	if (!file.good()) {
+		std::cerr << "Unable to open OBJ file: " << filename << std::endl;
+		return 1;
+	}
+	BenchMesh mesh(file);
+	mesh.build_bvh(resolve_thread_count(0));
+	int n_triangles = int(mesh.triangles.size());
+	if (n_triangles == 0 || n_rays <= 0) {
+		std::cerr << "Nothing to benchmark" << std::endl;
+		return 1;
+	}
+
+	// Rayons partant d'une sphère englobant le maillage et visant un point de son AABB.
+	AABB bounds = construct_aabb(mesh.positions);
+	double3 center = double3(centroid(bounds));
+	double radius = 2.0 * length(double3(bounds.max - bounds.min));
+
+	pcg32 rng;
+	std::vector<Ray> rays(n_rays);
+	for (auto& ray : rays) {
+		double3 target = double3(bounds.min) + double3(bounds.max - bounds.min) * double3{rng.nextDouble(), rng.nextDouble(), rng.nextDouble()};
+		double3 origin = center + radius * random_direction(rng);
+		ray.origin = real3(origin);
+		ray.direction = real3(normalize(target - origin));
+	}
+
+	// Test géométrique d'origine.
+	std::vector<real> reference(n_rays, REAL_MAX);
+	Clock::time_point start = Clock::now();
+	for (int iray = 0; iray < n_rays; iray++) {
+		for (const Triangle& tri : mesh.triangles) {
+			Intersection tmp;
+			if (mesh.intersect_triangle(rays[iray], EPSILON, reference[iray], tri, &tmp)) {
+				reference[iray] = tmp.depth;
+			}
+		}
+	}
+	double geometric_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	// Möller–Trumbore sur les triangles prétraités.
+	std::vector<real> result(n_rays, REAL_MAX);
+	start = Clock::now();
+	for (int iray = 0; iray < n_rays; iray++) {
+		for (int itri = 0; itri < n_triangles; itri++) {
+			real t;
+			if (mesh.store.intersect(itri, rays[iray], EPSILON, result[iray], &t)) {
+				result[iray] = t;
+			}
+		}
+	}
+	double store_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	// Même noyau par intervalle d'un registre AVX2 de triangles (4 en double, 8 en float), comme dans une feuille du BVH.
+	const int lanes = 32 / int(sizeof(real));
+	const TriangleStore& store = mesh.store;
+	std::vector<real> range_result(n_rays, REAL_MAX);
+	start = Clock::now();
+	for (int iray = 0; iray < n_rays; iray++) {
+		for (int itri = 0; itri < n_triangles; itri += lanes) {
+			store.intersect_range(itri, std::min(itri + lanes, n_triangles), rays[iray], EPSILON, &range_result[iray]);
+		}
+	}
+	double range_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+	// Les deux tests doivent trouver la même intersection la plus proche (aux erreurs d'arrondi près).
+	const double tolerance = sizeof(real) == sizeof(float) ? 1e-4 : 1e-6;
+	int n_hits = 0;
+	int n_mismatches = 0;
+	for (int iray = 0; iray < n_rays; iray++) {
+		n_hits += result[iray] < REAL_MAX;
+		bool same_hit = (reference[iray] < REAL_MAX) == (result[iray] < REAL_MAX);
+		if (!same_hit || (result[iray] < REAL_MAX && std::fabs(reference[iray] - result[iray]) > tolerance)) {
+			n_mismatches++;
+		}
+		// Le noyau par intervalle doit donner exactement la même profondeur.
+		if (range_result[iray] != result[iray]) {
+			n_mismatches++;
+		}
+	}
+
+	double n_tests = double(n_rays) * n_triangles;
+	std::cout << filename << ": " << n_triangles << " triangles, " << n_rays << " rays, " << n_hits << " hits, "
+	          << n_mismatches << " mismatches" << std::endl;
+	std::cout << "  geometric:       " << geometric_ms << " ms (" << 1e6 * geometric_ms / n_tests << " ns/test)" << std::endl;
+	std::cout << "  Moller-Trumbore: " << store_ms << " ms (" << 1e6 * store_ms / n_tests << " ns/test), speedup "
+	          << geometric_ms / store_ms << "x" << std::endl;
+	std::cout << "  Moller-Trumbore " << (cpu_has_avx2() ? "AVX2" : "scalar") << " x" << lanes << ": " << range_ms << " ms ("
+	          << 1e6 * range_ms / n_tests << " ns/test), speedup " << geometric_ms / range_ms << "x" << std::endl;
+	return 0;
+}
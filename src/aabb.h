@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cmath>
 #include <vector>
 
 #include "float.h"
@@ -7,23 +8,60 @@
 #include "linalg/linalg.h"
 using namespace linalg::aliases;
 
+// Rayon préparé pour le parcours des structures d'accélération: l'inverse de la direction et
+// le signe de chaque composante sont calculés une seule fois par rayon plutôt qu'à chaque boîte.
+struct TraversalRay {
+    real3 origin;
+    real3 inv_direction;
+
+    // 1 si la composante de la direction est négative: on entre alors dans la boîte par le plan max.
+    int sign[3];
+
+    TraversalRay(const Ray& ray) : origin(ray.origin) {
+        for (int axis = 0; axis < 3; axis++) {
+            inv_direction[axis] = real(1) / ray.direction[axis];
+            sign[axis] = std::signbit(ray.direction[axis]) ? 1 : 0;
+        }
+    }
+};
+
 class AABB{
 public:
-    double3 min;
-    double3 max;
+    real3 min;
+    real3 max;
 
     // Calcul l'intersection d'un rayon avec un AABB qui respecte l'intervalle de profondeur décrit.
-    bool intersect(Ray ray, double t_min, double t_max);
+    bool intersect(Ray ray, real t_min, real t_max) const;
+
+    // Même test pour un rayon préparé, sans division ni branchement: grâce à sign, le plan d'entrée
+    // et le plan de sortie de chaque axe sont connus d'avance. L'intervalle [t_min, t_max] est
+    // réduit axe par axe; si la direction est nulle selon un axe et que l'origine est sur l'un
+    // des plans (0 * inf), cet axe est ignoré.
+    bool intersect(const TraversalRay& ray, real t_min, real t_max) const {
+        for (int axis = 0; axis < 3; axis++) {
+            real t0 = ((ray.sign[axis] ? max : min)[axis] - ray.origin[axis]) * ray.inv_direction[axis];
+            real t1 = ((ray.sign[axis] ? min : max)[axis] - ray.origin[axis]) * ray.inv_direction[axis];
+            t_min = t0 > t_min ? t0 : t_min;
+            t_max = t1 < t_max ? t1 : t_max;
+        }
+        return t_min <= t_max;
+    }
 };
 
 // Retrouver les 8 coins associés au AABB.
-std::vector<double3> retrieve_corners(AABB aabb);
+std::vector<real3> retrieve_corners(AABB aabb);
 
 // Construit un AABB à partir d'une série de points.
-AABB construct_aabb(std::vector<double3> points);
+AABB construct_aabb(std::vector<real3> points);
 
 // Combine deux AABB afin de construire un AABB qui englobe les deux.
 AABB combine(AABB a, AABB b);
 
 // Détermine si le coin inférieur de b est plus grand que a par rapport à l'axe spécifiée.
-bool compare(AABB a, AABB b, int axis);
\ No newline at end of file
+bool compare(AABB a, AABB b, int axis);
+
+// Centre du AABB.
+real3 centroid(AABB aabb);
+
+// Aire de la surface du AABB (heuristique SAH).
+double surface_area(AABB aabb);
\ No newline at end of file
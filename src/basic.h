@@ -3,27 +3,17 @@
 #include "linalg/linalg.h"
 using namespace linalg::aliases;
 
-#define PI 3.14159265358979323846
-#define EPSILON 1e-6
+#include "constants.h"
 
-// Valeur aléatoire entre [0,1)
-static double rand_double() {
-	return double(rand()) / double((RAND_MAX));
-}
-
-// Valeur aléatoire entre [0,1] pour un vecteur
-static double2 rand_double2() {
-	return double2{rand_double(),rand_double()};
-}
+#include <algorithm>
+#include <limits>
 
-// Valeur aléatoire à l'intérieur d'un disque.
-static double2 random_in_unit_disk() {
-    while (true) {
-        auto p = (2.0 * rand_double2() - 1.0);
-        if (length2(p) >= 1) continue;
-        return p;
-    }
-}
+// Vecteurs et matrices du type scalaire de la géométrie (voir real dans constants.h).
+typedef linalg::vec<real, 2> real2;
+typedef linalg::vec<real, 3> real3;
+typedef linalg::vec<real, 4> real4;
+typedef linalg::mat<real, 3, 3> real3x3;
+typedef linalg::mat<real, 4, 4> real4x4;
 
 // Convertir radian vers degrée
 static double rad2deg(double rad) {
@@ -35,17 +25,24 @@ static double deg2rad(double deg) {
 	return deg * 2 * PI / 360.0;
 }
 
+// Profondeur minimale (t_min) d'un rayon partant du point p, e.g. un rayon d'ombre partant d'une surface.
+// EPSILON en double; en float, EPSILON est sous la résolution à l'échelle de la scène (un ulp vaut
+// environ 6e-8 * |p|), le décalage suit donc la grandeur des coordonnées de p.
+inline real ray_epsilon(real3 p) {
+	return std::max(real(EPSILON), 32 * std::numeric_limits<real>::epsilon() * maxelem(abs(p)));
+}
+
 // Une classe qui représente un rayon
 class Ray 
 {
 public:
 	Ray() : origin(0, 0, 0), direction(0, 0, 0) {}
-	Ray(double3 origin_, double3 direction_) :
+	Ray(real3 origin_, real3 direction_) :
 		origin(origin_), direction(direction_)
 	{
 
 	}
 
-	double3 origin;    // Origine du rayon
-	double3 direction; // Direction du rayon
+	real3 origin;    // Origine du rayon
+	real3 direction; // Direction du rayon
 };
\ No newline at end of file
@@ -0,0 +1,386 @@
+#include "bvh.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <numeric>
+
+#include "scheduler.h"
+
+namespace {
+
+// Intervalles (bins) SAH des trois axes pour un intervalle d'objets.
+struct SAHBins {
+	int counts[3][BVH_MAX_BINS];
+	AABB bounds[3][BVH_MAX_BINS];
+};
+
+// AABB des objets et AABB de leurs centroïdes pour un intervalle d'objets.
+struct RangeSummary {
+	AABB bounds;
+	AABB centroid_bounds;
+	bool empty = true;
+};
+
+// Intervalle de l'axe axis contenant la coordonnée c.
+inline int bin_index(real c, const AABB& centroid_bounds, int axis, int n_bins) {
+	real extent = centroid_bounds.max[axis] - centroid_bounds.min[axis];
+	return std::min(int(n_bins * (c - centroid_bounds.min[axis]) / extent), n_bins - 1);
+}
+
+// Appelle fn(ichunk, begin, end) sur n_chunks blocs consécutifs de [idx_start, idx_end).
+// Les blocs sont traités en parallèle lorsque n_chunks > 1.
+void for_each_chunk(int idx_start, int idx_end, int n_chunks, const std::function<void(int, int, int)>& fn) {
+	long long n = idx_end - idx_start;
+	if (n_chunks <= 1) {
+		fn(0, idx_start, idx_end);
+		return;
+	}
+	parallel_for(n_chunks, n_chunks, [&](int ichunk) {
+		fn(ichunk, idx_start + int(n * ichunk / n_chunks), idx_start + int(n * (ichunk + 1) / n_chunks));
+	});
+}
+
+}
+
+void BVHTree::build(std::vector<AABB> aabbs, BVHBuildMode mode, BVHCostModel cost, int num_threads) {
+	auto start = std::chrono::steady_clock::now();
+	int n = int(aabbs.size());
+
+	build_mode = mode;
+	cost_model = cost;
+	build_threads = std::max(num_threads, 1);
+	stats = BVHBuildStats();
+	nodes.clear();
+
+	build_aabbs.swap(aabbs);
+	build_centroids.resize(n);
+	indices.resize(n);
+	for (int iprim = 0; iprim < n; iprim++) {
+		build_centroids[iprim] = centroid(build_aabbs[iprim]);
+		indices[iprim] = iprim;
+	}
+
+	// Environ 8 sous-arbres par fil afin d'équilibrer la charge lorsque la scène est inégalement répartie.
+	task_size = std::max(n / (8 * build_threads), BVH_MIN_TASK_SIZE);
+
+	size_t build_bytes = build_aabbs.capacity() * sizeof(AABB) + build_centroids.capacity() * sizeof(real3)
+		+ indices.capacity() * sizeof(int);
+
+	if (n > 0 && (build_threads == 1 || n <= task_size)) {
+		// Un arbre binaire avec au plus un objet par feuille a au plus 2n - 1 noeuds:
+		// on réserve d'avance afin que nodes ne soit jamais réalloué pendant la construction.
+		BVHSubtree tree;
+		tree.nodes.reserve(2 * size_t(n) - 1);
+		build_node(tree, 0, n, 0, 0);
+
+		nodes.swap(tree.nodes);
+		stats.n_leaves = tree.n_leaves;
+		stats.max_depth = tree.max_depth;
+		stats.peak_bytes = build_bytes + nodes.capacity() * sizeof(LinearBVHNode);
+	}
+	else if (n > 0) {
+		// Niveaux supérieurs sur le fil appelant.
+		BVHSubtree top;
+		top.defer_tasks = true;
+		build_node(top, 0, n, 0, 0);
+
+		// Sous-arbres différés, les plus gros en premier afin de ne pas terminer sur une longue tâche.
+		std::vector<int> order(build_tasks.size());
+		std::iota(order.begin(), order.end(), 0);
+		std::sort(order.begin(), order.end(), [&](int a, int b) {
+			return build_tasks[a].idx_end - build_tasks[a].idx_start > build_tasks[b].idx_end - build_tasks[b].idx_start;
+		});
+
+		std::vector<BVHSubtree> subtrees(build_tasks.size());
+		parallel_for(int(order.size()), build_threads, [&](int i) {
+			const BVHBuildTask& task = build_tasks[order[i]];
+			BVHSubtree& tree = subtrees[order[i]];
+			tree.nodes.reserve(2 * size_t(task.idx_end - task.idx_start) - 1);
+			build_node(tree, task.idx_start, task.idx_end, task.axis, task.depth);
+		});
+
+		// Recopie dans un seul tableau contigu, en ordre de parcours en profondeur.
+		size_t n_nodes = top.nodes.size() - subtrees.size();
+		stats.n_leaves = top.n_leaves;
+		stats.max_depth = top.max_depth;
+		stats.peak_bytes = build_bytes + top.nodes.capacity() * sizeof(LinearBVHNode);
+		for (const BVHSubtree& tree : subtrees) {
+			n_nodes += tree.nodes.size();
+			stats.n_leaves += tree.n_leaves;
+			stats.max_depth = std::max(stats.max_depth, tree.max_depth);
+			stats.peak_bytes += tree.nodes.capacity() * sizeof(LinearBVHNode);
+		}
+
+		nodes.reserve(n_nodes);
+		splice(top, subtrees, 0);
+		stats.peak_bytes += nodes.capacity() * sizeof(LinearBVHNode);
+
+		std::vector<BVHBuildTask>().swap(build_tasks);
+	}
+
+	stats.n_nodes = int(nodes.size());
+
+	// Les données de construction ne servent plus au parcours.
+	std::vector<AABB>().swap(build_aabbs);
+	std::vector<real3>().swap(build_centroids);
+	if (nodes.capacity() > 2 * nodes.size()) {
+		nodes.shrink_to_fit();
+	}
+
+	stats.build_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BVHBuildStats::print(std::ostream& out, const char* name, int n_objects, const char* object_name) const {
+	out << name << ": " << n_objects << " " << object_name << ", " << n_nodes << " nodes (" << n_leaves << " leaves), depth "
+	    << max_depth << ", built in " << build_milliseconds << " ms, peak memory "
+	    << peak_bytes / (1024.0 * 1024.0) << " MB" << std::endl;
+}
+
+AABB BVHTree::range_bounds(int idx_start, int idx_end, bool parallel) {
+	std::vector<RangeSummary> partial(parallel ? build_threads : 1);
+	for_each_chunk(idx_start, idx_end, int(partial.size()), [&](int ichunk, int begin, int end) {
+		if (begin == end) {
+			return;
+		}
+		AABB bounds = build_aabbs[indices[begin]];
+		for (int i = begin + 1; i < end; i++) {
+			bounds = combine(bounds, build_aabbs[indices[i]]);
+		}
+		partial[ichunk].bounds = bounds;
+		partial[ichunk].empty = false;
+	});
+
+	AABB bounds = partial[0].bounds;
+	for (size_t i = 1; i < partial.size(); i++) {
+		if (!partial[i].empty) {
+			bounds = combine(bounds, partial[i].bounds);
+		}
+	}
+	return bounds;
+}
+
+int BVHTree::make_leaf(BVHSubtree& out, int idx_start, int idx_end, AABB aabb, int depth) {
+	out.n_leaves++;
+	out.max_depth = std::max(out.max_depth, depth);
+
+	out.nodes.push_back(LinearBVHNode{aabb, idx_start, idx_end - idx_start, 0});
+	return int(out.nodes.size()) - 1;
+}
+
+int BVHTree::make_interior(BVHSubtree& out, AABB aabb, int axis) {
+	out.nodes.push_back(LinearBVHNode{aabb, 0, 0, axis});
+	return int(out.nodes.size()) - 1;
+}
+
+int BVHTree::build_node(BVHSubtree& out, int idx_start, int idx_end, int axis, int depth) {
+	if (out.defer_tasks && idx_end - idx_start <= task_size) {
+		// Noeud différé: offset référence la tâche, le reste est rempli lors de la recopie.
+		build_tasks.push_back(BVHBuildTask{idx_start, idx_end, axis, depth});
+		out.nodes.push_back(LinearBVHNode{AABB(), int(build_tasks.size()) - 1, -1, 0});
+		return int(out.nodes.size()) - 1;
+	}
+
+	if (build_mode == BVHBuildMode::SAH) {
+		return sah_build(out, idx_start, idx_end, depth);
+	}
+	return recursive_build(out, idx_start, idx_end, axis, depth);
+}
+
+int BVHTree::splice(const BVHSubtree& top, const std::vector<BVHSubtree>& subtrees, int inode) {
+	const LinearBVHNode& node = top.nodes[inode];
+	int base = int(nodes.size());
+
+	if (node.n_objects < 0) {
+		// Les index d'enfants du sous-arbre sont relatifs à sa racine.
+		for (LinearBVHNode child : subtrees[node.offset].nodes) {
+			if (child.n_objects == 0) {
+				child.offset += base;
+			}
+			nodes.push_back(child);
+		}
+		return base;
+	}
+
+	nodes.push_back(node);
+	if (node.n_objects == 0) {
+		splice(top, subtrees, inode + 1);
+		nodes[base].offset = splice(top, subtrees, node.offset);
+	}
+	return base;
+}
+
+int BVHTree::recursive_build(BVHSubtree& out, int idx_start, int idx_end, int axis, int depth) {
+	bool parallel = out.defer_tasks && idx_end - idx_start >= BVH_PARALLEL_BINNING_SIZE;
+	AABB bounds = range_bounds(idx_start, idx_end, parallel);
+
+	//s'il y a un seul élément, il s'agit d'une feuille. On arrête la récursion.
+	if (idx_end - idx_start == 1) {
+		return make_leaf(out, idx_start, idx_end, bounds, depth);
+	}
+
+	// sinon, on sépare à la médiane selon le coin inférieur des AABB et on parcourt récursivement
+	int mid = idx_start + (idx_end - idx_start)/2;
+	std::nth_element(indices.begin() + idx_start, indices.begin() + mid, indices.begin() + idx_end,
+		[&](int a, int b) { return compare(build_aabbs[a], build_aabbs[b], axis); });
+
+	int inode = make_interior(out, bounds, axis);
+	build_node(out, idx_start, mid, (axis+1)%3, depth + 1);
+	out.nodes[inode].offset = build_node(out, mid, idx_end, (axis+1)%3, depth + 1);
+	return inode;
+}
+
+// Construction SAH:
+// - Les centroïdes des objets sont répartis dans cost_model.n_bins intervalles sur chaque axe.
+// - Pour chaque frontière entre intervalles, on évalue le coût SAH de la séparation.
+// - On garde la séparation la moins coûteuse, à moins qu'une feuille ne coûte moins cher.
+// - L'intervalle d'index est partitionné sur place selon la séparation choisie.
+// Pour les grands intervalles des niveaux supérieurs, les AABB et les intervalles sont accumulés
+// par bloc sur plusieurs fils puis fusionnés.
+int BVHTree::sah_build(BVHSubtree& out, int idx_start, int idx_end, int depth) {
+	int n = idx_end - idx_start;
+	int n_chunks = out.defer_tasks && n >= BVH_PARALLEL_BINNING_SIZE ? build_threads : 1;
+
+	std::vector<RangeSummary> summaries(n_chunks);
+	for_each_chunk(idx_start, idx_end, n_chunks, [&](int ichunk, int begin, int end) {
+		if (begin == end) {
+			return;
+		}
+		RangeSummary& summary = summaries[ichunk];
+		summary.bounds = build_aabbs[indices[begin]];
+		summary.centroid_bounds = AABB{build_centroids[indices[begin]], build_centroids[indices[begin]]};
+		summary.empty = false;
+		for (int i = begin + 1; i < end; i++) {
+			summary.bounds = combine(summary.bounds, build_aabbs[indices[i]]);
+			real3 c = build_centroids[indices[i]];
+			summary.centroid_bounds = AABB{min(summary.centroid_bounds.min, c), max(summary.centroid_bounds.max, c)};
+		}
+	});
+
+	AABB bounds = summaries[0].bounds;
+	AABB centroid_bounds = summaries[0].centroid_bounds;
+	for (int ichunk = 1; ichunk < n_chunks; ichunk++) {
+		if (!summaries[ichunk].empty) {
+			bounds = combine(bounds, summaries[ichunk].bounds);
+			centroid_bounds = combine(centroid_bounds, summaries[ichunk].centroid_bounds);
+		}
+	}
+
+	if (n == 1) {
+		return make_leaf(out, idx_start, idx_end, bounds, depth);
+	}
+
+	int n_bins = std::min(std::max(cost_model.n_bins, 2), BVH_MAX_BINS);
+	double leaf_cost = cost_model.intersection_cost * n;
+	double best_cost = DBL_MAX;
+	int best_axis = -1;
+	int best_split = 0;
+
+	// Près de la limite de la pile de parcours, on n'évalue plus la SAH: les séparations à la médiane
+	// garantissent une profondeur logarithmique pour le reste du sous-arbre.
+	bool use_sah = depth < BVH_STACK_SIZE - 32;
+
+	bool active[3];
+	for (int axis = 0; axis < 3; axis++) {
+		active[axis] = use_sah && centroid_bounds.max[axis] - centroid_bounds.min[axis] > 0;
+	}
+
+	// Les trois axes sont remplis en un seul passage sur l'intervalle.
+	std::vector<SAHBins> chunk_bins(use_sah ? n_chunks : 0);
+	for_each_chunk(idx_start, idx_end, int(chunk_bins.size()), [&](int ichunk, int begin, int end) {
+		SAHBins& bins = chunk_bins[ichunk];
+		for (int axis = 0; axis < 3; axis++) {
+			std::fill(bins.counts[axis], bins.counts[axis] + n_bins, 0);
+		}
+		for (int i = begin; i < end; i++) {
+			int iobj = indices[i];
+			for (int axis = 0; axis < 3; axis++) {
+				if (!active[axis]) {
+					continue;
+				}
+				int b = bin_index(build_centroids[iobj][axis], centroid_bounds, axis, n_bins);
+				bins.bounds[axis][b] = bins.counts[axis][b] ? combine(bins.bounds[axis][b], build_aabbs[iobj]) : build_aabbs[iobj];
+				bins.counts[axis][b]++;
+			}
+		}
+	});
+
+	for (int axis = 0; axis < 3 && use_sah; axis++) {
+		if (!active[axis]) {
+			continue;
+		}
+
+		// Fusion des intervalles de chaque bloc.
+		int counts[BVH_MAX_BINS] = {0};
+		AABB bin_bounds[BVH_MAX_BINS];
+		for (const SAHBins& bins : chunk_bins) {
+			for (int b = 0; b < n_bins; b++) {
+				if (bins.counts[axis][b]) {
+					bin_bounds[b] = counts[b] ? combine(bin_bounds[b], bins.bounds[axis][b]) : bins.bounds[axis][b];
+					counts[b] += bins.counts[axis][b];
+				}
+			}
+		}
+
+		// Balayage de droite à gauche: aire et nombre d'objets à droite de chaque frontière.
+		double right_area[BVH_MAX_BINS];
+		int right_count[BVH_MAX_BINS];
+		AABB acc;
+		int acc_count = 0;
+		for (int b = n_bins - 1; b > 0; b--) {
+			if (counts[b]) {
+				acc = acc_count ? combine(acc, bin_bounds[b]) : bin_bounds[b];
+				acc_count += counts[b];
+			}
+			right_count[b] = acc_count;
+			right_area[b] = acc_count ? surface_area(acc) : 0.0;
+		}
+
+		// Balayage de gauche à droite en évaluant le coût de chaque frontière.
+		acc_count = 0;
+		for (int b = 0; b < n_bins - 1; b++) {
+			if (counts[b]) {
+				acc = acc_count ? combine(acc, bin_bounds[b]) : bin_bounds[b];
+				acc_count += counts[b];
+			}
+			if (acc_count == 0 || right_count[b + 1] == 0) {
+				continue;
+			}
+
+			double cost = cost_model.traversal_cost + cost_model.intersection_cost *
+				(surface_area(acc) * acc_count + right_area[b + 1] * right_count[b + 1]) / surface_area(bounds);
+			if (cost < best_cost) {
+				best_cost = cost;
+				best_axis = axis;
+				best_split = b;
+			}
+		}
+	}
+
+	if (n <= cost_model.max_leaf_size && (best_axis < 0 || leaf_cost <= best_cost)) {
+		return make_leaf(out, idx_start, idx_end, bounds, depth);
+	}
+
+	int mid;
+	int axis = best_axis;
+	if (best_axis >= 0) {
+		auto it = std::partition(indices.begin() + idx_start, indices.begin() + idx_end, [&](int iobj) {
+			return bin_index(build_centroids[iobj][axis], centroid_bounds, axis, n_bins) <= best_split;
+		});
+		mid = int(it - indices.begin());
+	}
+	else {
+		// Aucune séparation SAH possible (centroïdes confondus ou profondeur limite): séparation à la médiane
+		// selon l'axe le plus étendu.
+		real3 extent = centroid_bounds.max - centroid_bounds.min;
+		axis = extent.x > extent.y ? (extent.x > extent.z ? 0 : 2) : (extent.y > extent.z ? 1 : 2);
+		mid = idx_start + n / 2;
+		std::nth_element(indices.begin() + idx_start, indices.begin() + mid, indices.begin() + idx_end,
+			[&](int a, int b) { return build_centroids[a][axis] < build_centroids[b][axis]; });
+	}
+
+	int inode = make_interior(out, bounds, axis);
+	build_node(out, idx_start, mid, 0, depth + 1);
+	out.nodes[inode].offset = build_node(out, mid, idx_end, 0, depth + 1);
+	return inode;
+}
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <iostream>
+#include <vector>
+
+#include "basic.h"
+#include "aabb.h"
+
+// Noeud de l'arbre BVH linéarisé.
+// Les noeuds sont stockés dans un seul tableau contigu en ordre de parcours en profondeur:
+// l'enfant de gauche d'un noeud interne est toujours le noeud qui le suit immédiatement.
+// Aligné sur 64 octets afin qu'un noeud occupe exactement une ligne de cache.
+struct alignas(64) LinearBVHNode {
+    // AABB englobant le sous-arbre.
+    AABB aabb;
+
+    // Feuille: index de la première primitive dans BVHTree::indices. Noeud interne: index de l'enfant de droite.
+    int offset;
+
+    // Nombre de primitives de la feuille (0 pour un noeud interne).
+    int n_objects;
+
+    // Axe de séparation des deux enfants, utilisé pour visiter l'enfant le plus proche en premier.
+    int axis;
+};
+
+// Profondeur maximale de la pile de parcours du BVH.
+#define BVH_STACK_SIZE 64
+
+// Nombre maximal d'intervalles (bins) par axe pour la construction SAH.
+#define BVH_MAX_BINS 64
+
+// Taille minimale d'un sous-arbre confié à un fil lors de la construction parallèle.
+#define BVH_MIN_TASK_SIZE 4096
+
+// Taille minimale d'un intervalle dont les AABB et les intervalles SAH sont calculés en parallèle.
+#define BVH_PARALLEL_BINNING_SIZE 65536
+
+// Méthode de construction de l'arbre BVH.
+enum class BVHBuildMode {
+    // Séparation à la médiane, axe choisi à tour de rôle (container "BVH").
+    Median,
+    // Heuristique de surface (SAH) sur des intervalles de centroïdes (container "BVH_SAH").
+    SAH
+};
+
+// Modèle de coût de l'heuristique SAH.
+// Coût d'un noeud interne = traversal_cost + intersection_cost * (A_g * N_g + A_d * N_d) / A
+// où A est l'aire de surface d'un AABB et N le nombre d'objets de chaque côté.
+struct BVHCostModel {
+    // Coût relatif du test d'un AABB lors du parcours.
+    double traversal_cost = 1.0;
+    // Coût relatif de l'intersection avec un objet.
+    double intersection_cost = 1.0;
+    // Nombre d'intervalles (bins) évalués par axe [2, BVH_MAX_BINS].
+    int n_bins = 16;
+    // Nombre maximal d'objets dans une feuille.
+    int max_leaf_size = 4;
+};
+
+// Statistiques de la construction d'un BVH.
+struct BVHBuildStats {
+    // Durée de la construction (ms).
+    double build_milliseconds = 0;
+    // Nombre de noeuds et de feuilles de l'arbre.
+    int n_nodes = 0;
+    int n_leaves = 0;
+    // Profondeur maximale de l'arbre.
+    int max_depth = 0;
+    // Mémoire maximale utilisée par les tableaux de construction et l'arbre (octets).
+    size_t peak_bytes = 0;
+
+    // Écrit un résumé d'une ligne.
+    void print(std::ostream& out, const char* name, int n_objects, const char* object_name = "objects") const;
+};
+
+// Sous-arbre en cours de construction. Les noeuds sont en ordre de parcours en profondeur et
+// les index d'enfants sont locaux à ce sous-arbre.
+struct BVHSubtree {
+    std::vector<LinearBVHNode> nodes;
+    int n_leaves = 0;
+    int max_depth = 0;
+
+    // Vrai pour les niveaux supérieurs d'une construction parallèle: les intervalles d'au plus
+    // task_size objets ne sont pas construits mais remplacés par un noeud différé (n_objects < 0).
+    bool defer_tasks = false;
+};
+
+// Sous-arbre différé, construit ensuite par l'un des fils.
+struct BVHBuildTask {
+    int idx_start, idx_end;
+    int axis;
+    int depth;
+};
+
+// Arbre BVH linéarisé sur une liste de primitives (objets de la scène ou triangles d'un maillage)
+// décrites uniquement par leur AABB.
+//
+// La construction travaille sur place sur un seul tableau d'index (indices):
+// chaque noeud partitionne son intervalle [idx_start, idx_end) et les feuilles référencent
+// directement un sous-intervalle de ce tableau. Les noeuds sont ajoutés au fur et à mesure,
+// en ordre de parcours en profondeur; aucun arbre intermédiaire n'est alloué.
+//
+// Avec plusieurs fils, les niveaux supérieurs sont construits par le fil appelant (les AABB et
+// les intervalles SAH des grands intervalles sont alors calculés en parallèle), puis chaque
+// sous-arbre restant est construit indépendamment par un fil dans son propre tableau. Les
+// sous-intervalles de indices étant disjoints, les fils ne partagent aucune donnée
+// modifiable. Les sous-arbres sont finalement recopiés dans nodes en ordre de parcours en profondeur;
+// l'arbre obtenu est identique peu importe le nombre de fils.
+class BVHTree {
+public:
+    // Index des primitives ordonnées par feuille: la feuille couvre indices[offset, offset + n_objects).
+    std::vector<int> indices;
+
+    // Arbre linéarisé, la racine est nodes[0].
+    std::vector<LinearBVHNode> nodes;
+
+    // Statistiques de la construction.
+    BVHBuildStats stats;
+
+    // Construit l'arbre sur les primitives décrites par aabbs avec num_threads fils.
+    void build(std::vector<AABB> aabbs, BVHBuildMode mode, BVHCostModel cost, int num_threads);
+
+    // Parcourt l'arbre en visitant d'abord l'enfant le plus proche selon la direction du rayon.
+    // Pour chaque feuille touchée, leaf(i, t_max) est appelé pour chaque position i de la feuille
+    // dans indices. leaf retourne vrai s'il y a intersection avec la primitive, et réduit alors t_max
+    // à la profondeur trouvée. Retourne vrai si au moins une primitive est intersectée.
+    // Avec AnyHit, le parcours s'arrête à la première primitive intersectée (rayons d'ombre).
+    template <bool AnyHit = false, typename LeafFn>
+    bool traverse(const Ray& ray, real t_min, real t_max, LeafFn&& leaf) const {
+        return traverse_leaves<AnyHit>(ray, t_min, t_max, [&](int begin, int end, real& max_dist) {
+            bool hit_bool = false;
+            for (int i = begin; i < end; i++) {
+                if (leaf(i, max_dist)) {
+                    hit_bool = true;
+                    if (AnyHit) {
+                        break;
+                    }
+                }
+            }
+            return hit_bool;
+        });
+    }
+
+    // Comme traverse, mais leaf(begin, end, t_max) reçoit l'intervalle [begin, end) complet de la
+    // feuille, e.g. pour tester plusieurs primitives à la fois avec un noyau vectoriel.
+    template <bool AnyHit = false, typename LeafFn>
+    bool traverse_leaves(const Ray& ray, real t_min, real t_max, LeafFn&& leaf) const {
+        if (nodes.empty()) {
+            return false;
+        }
+
+        bool hit_bool = false;
+        TraversalRay traversal_ray(ray);
+
+        // Pile de taille fixe des noeuds à visiter (aucune récursion ni allocation).
+        int stack[BVH_STACK_SIZE];
+        int stack_size = 0;
+        int inode = 0;
+
+        while (true) {
+            const LinearBVHNode& node = nodes[inode];
+
+            if (node.aabb.intersect(traversal_ray, t_min, t_max)) {
+                if (node.n_objects > 0) { // Feuille: intersection avec la géométrie
+                    if (leaf(node.offset, node.offset + node.n_objects, t_max)) {
+                        hit_bool = true;
+                        if (AnyHit) {
+                            return true;
+                        }
+                    }
+                }
+                else { // Noeud interne: on visite d'abord l'enfant le plus proche selon la direction du rayon
+                    if (traversal_ray.sign[node.axis]) {
+                        stack[stack_size++] = inode + 1;
+                        inode = node.offset;
+                    }
+                    else {
+                        stack[stack_size++] = node.offset;
+                        inode = inode + 1;
+                    }
+                    continue;
+                }
+            }
+
+            if (stack_size == 0) {
+                break;
+            }
+            inode = stack[--stack_size];
+        }
+
+        return hit_bool;
+    }
+
+private:
+    // Méthode de construction et paramètres de l'heuristique SAH.
+    BVHBuildMode build_mode;
+    BVHCostModel cost_model;
+
+    // Nombre de fils de la construction et taille maximale d'un sous-arbre différé.
+    int build_threads;
+    int task_size;
+
+    // Sous-arbres différés par les niveaux supérieurs.
+    std::vector<BVHBuildTask> build_tasks;
+
+    // AABB et centroïde de chaque primitive. Libérés après la construction.
+    std::vector<AABB> build_aabbs;
+    std::vector<real3> build_centroids;
+
+    // Fonction recursive permettant la construction de notre arbre BVH
+    // On choisit à tour de rôle un axe. On sépare l'intervalle à la médiane selon cet axe
+    // (nth_element, sans trier tout l'intervalle).
+    // On construit récursivement les autres noeuds également.
+    // Retourne l'index du noeud créé.
+    int recursive_build(BVHSubtree& out, int idx_start, int idx_end, int axis, int depth);
+
+    // Construction selon l'heuristique SAH. Retourne l'index du noeud créé.
+    int sah_build(BVHSubtree& out, int idx_start, int idx_end, int depth);
+
+    // Construit le noeud couvrant indices[idx_start, idx_end) selon build_mode,
+    // ou le diffère si l'intervalle est assez petit pour être confié à un fil.
+    int build_node(BVHSubtree& out, int idx_start, int idx_end, int axis, int depth);
+
+    // Ajoute une feuille pour les primitives indices[idx_start, idx_end).
+    int make_leaf(BVHSubtree& out, int idx_start, int idx_end, AABB aabb, int depth);
+
+    // Ajoute un noeud interne; ses enfants doivent être construits immédiatement après.
+    int make_interior(BVHSubtree& out, AABB aabb, int axis);
+
+    // Recopie le noeud top.nodes[inode] et ses descendants à la fin de nodes en remplaçant
+    // chaque noeud différé par son sous-arbre. Retourne l'index du noeud dans nodes.
+    int splice(const BVHSubtree& top, const std::vector<BVHSubtree>& subtrees, int inode);
+
+    // AABB englobant les primitives indices[idx_start, idx_end).
+    AABB range_bounds(int idx_start, int idx_end, bool parallel);
+};
@@ -0,0 +1,124 @@
+#include "bvh4.h"
+#include "cpu.h"
+
+#include <utility>
+
+namespace {
+
+typedef int (*IntersectAABB4)(const real*, const real*, const real*, const int*, real, real, real*);
+
+// Repli scalaire: test des plans pour chaque enfant, un à la fois, comme AABB::intersect(TraversalRay).
+int intersect_aabb4_scalar(const real* bounds, const real origin[3], const real inv_direction[3],
+                           const int sign[3], real t_min, real t_max, real t_near[BVH4_WIDTH]) {
+	int mask = 0;
+	for (int i = 0; i < BVH4_WIDTH; i++) {
+		real t_enter = t_min;
+		real t_exit = t_max;
+		for (int axis = 0; axis < 3; axis++) {
+			// Plan d'entrée (min, ou max si la direction est négative) et plan de sortie.
+			real t0 = (bounds[BVH4_WIDTH * (3 * sign[axis] + axis) + i] - origin[axis]) * inv_direction[axis];
+			real t1 = (bounds[BVH4_WIDTH * (3 * (1 - sign[axis]) + axis) + i] - origin[axis]) * inv_direction[axis];
+			t_enter = t0 > t_enter ? t0 : t_enter;
+			t_exit = t1 < t_exit ? t1 : t_exit;
+		}
+		t_near[i] = t_enter;
+		if (t_enter <= t_exit) {
+			mask |= 1 << i;
+		}
+	}
+	return mask;
+}
+
+IntersectAABB4 select_kernel() {
+#if defined(RAY_HAS_AVX2_KERNELS)
+	if (cpu_has_avx2()) {
+		return intersect_aabb4_avx2;
+	}
+#endif
+	return intersect_aabb4_scalar;
+}
+
+}
+
+int intersect_aabb4(const real bounds[6][BVH4_WIDTH], const TraversalRay& ray,
+                    real t_min, real t_max, real t_near[BVH4_WIDTH]) {
+	static const IntersectAABB4 kernel = select_kernel();
+	return kernel(&bounds[0][0], &ray.origin[0], &ray.inv_direction[0], ray.sign, t_min, t_max, t_near);
+}
+
+void BVH4Tree::build(BVHTree& tree) {
+	nodes.clear();
+	indices.swap(tree.indices);
+	if (tree.nodes.empty()) {
+		return;
+	}
+
+	// Un noeud BVH4 remplace au moins un noeud interne binaire.
+	nodes.reserve(tree.nodes.size() / 2 + 1);
+	collapse(tree, 0);
+}
+
+int BVH4Tree::collapse(const BVHTree& tree, int ibinary) {
+	// Enfants binaires regroupés dans ce noeud. Si la racine est une feuille, elle devient l'unique enfant.
+	int children[BVH4_WIDTH];
+	int n_children = 0;
+	if (tree.nodes[ibinary].n_objects > 0) {
+		children[n_children++] = ibinary;
+	}
+	else {
+		children[n_children++] = ibinary + 1;
+		children[n_children++] = tree.nodes[ibinary].offset;
+	}
+
+	// On ouvre l'enfant interne de plus grande aire jusqu'à avoir BVH4_WIDTH enfants.
+	while (n_children < BVH4_WIDTH) {
+		int largest = -1;
+		double largest_area = -1;
+		for (int i = 0; i < n_children; i++) {
+			const LinearBVHNode& node = tree.nodes[children[i]];
+			if (node.n_objects == 0 && surface_area(node.aabb) > largest_area) {
+				largest = i;
+				largest_area = surface_area(node.aabb);
+			}
+		}
+		if (largest < 0) {
+			break;
+		}
+		int inode = children[largest];
+		children[largest] = inode + 1;
+		children[n_children++] = tree.nodes[inode].offset;
+	}
+
+	int index = int(nodes.size());
+	nodes.push_back(BVH4Node());
+	for (int i = 0; i < BVH4_WIDTH; i++) {
+		BVH4Node& node = nodes[index];
+		if (i >= n_children) {
+			// Enfant absent: boîte vide, ignorée lors du parcours.
+			for (int axis = 0; axis < 3; axis++) {
+				node.bounds[axis][i] = REAL_MAX;
+				node.bounds[3 + axis][i] = -REAL_MAX;
+			}
+			node.child[i] = -1;
+			node.count[i] = 0;
+			continue;
+		}
+
+		const LinearBVHNode& binary = tree.nodes[children[i]];
+		for (int axis = 0; axis < 3; axis++) {
+			node.bounds[axis][i] = binary.aabb.min[axis];
+			node.bounds[3 + axis][i] = binary.aabb.max[axis];
+		}
+		node.count[i] = binary.n_objects;
+		if (binary.n_objects > 0) {
+			node.child[i] = binary.offset;
+		}
+		else {
+			// collapse ajoute des noeuds: on ne garde pas de référence vers nodes pendant l'appel.
+			int ichild = collapse(tree, children[i]);
+			nodes[index].child[i] = ichild;
+		}
+	}
+
+	return index;
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+
+#include "basic.h"
+#include "aabb.h"
+#include "bvh.h"
+
+// Profondeur maximale de la pile de parcours du BVH4: chaque noeud visité empile au plus
+// BVH4_WIDTH - 1 enfants de plus qu'il n'en retire, et l'arbre n'est pas plus profond que le BVH binaire.
+#define BVH4_STACK_SIZE ((BVH4_WIDTH - 1) * BVH_STACK_SIZE + 1)
+
+// Noeud d'un BVH à 4 enfants.
+// Les boîtes des enfants sont rangées en structure de tableaux (SoA) afin qu'un rayon soit testé
+// contre les 4 boîtes en un seul test de plans (slab test) vectoriel.
+struct alignas(64) BVH4Node {
+    // bounds[axis][i] = min de l'enfant i selon axis, bounds[3 + axis][i] = max.
+    real bounds[6][BVH4_WIDTH];
+
+    // Enfant i: absent si child[i] < 0, noeud interne (child[i] = index dans nodes) si count[i] == 0,
+    // sinon feuille couvrant indices[child[i], child[i] + count[i]).
+    int child[BVH4_WIDTH];
+    int count[BVH4_WIDTH];
+};
+
+// Quatre boîtes rangées en SoA, même disposition que BVH4Node::bounds (e.g. les objets du container Naive).
+struct alignas(32) AABB4 {
+    real bounds[6][BVH4_WIDTH];
+};
+
+// Teste le rayon contre 4 boîtes rangées comme BVH4Node::bounds. Retourne un masque des boîtes touchées
+// dans [t_min, t_max] et écrit leur profondeur d'entrée dans t_near.
+// Utilise le noyau AVX2 si le processeur le supporte.
+int intersect_aabb4(const real bounds[6][BVH4_WIDTH], const TraversalRay& ray,
+                    real t_min, real t_max, real t_near[BVH4_WIDTH]);
+
+// BVH à 4 enfants par noeud, obtenu en réduisant un BVHTree binaire: chaque noeud absorbe
+// ses petits-enfants (en commençant par celui dont l'aire de surface est la plus grande)
+// jusqu'à avoir 4 enfants. Les noeuds sont en ordre de parcours en profondeur.
+class BVH4Tree {
+public:
+    // Index des primitives ordonnées par feuille (repris du BVHTree).
+    std::vector<int> indices;
+
+    // Arbre linéarisé, la racine est nodes[0].
+    std::vector<BVH4Node> nodes;
+
+    // Réduit l'arbre binaire tree; tree.indices est déplacé dans indices.
+    void build(BVHTree& tree);
+
+    // Parcourt l'arbre en visitant les enfants touchés du plus proche au plus éloigné.
+    // Pour chaque feuille touchée, leaf(begin, end, t_max) reçoit l'intervalle [begin, end) de indices;
+    // leaf retourne vrai s'il y a intersection, et réduit alors t_max à la profondeur trouvée.
+    // Les enfants dont la profondeur d'entrée dépasse t_max ne sont plus visités.
+    // Avec AnyHit, le parcours s'arrête à la première feuille intersectée (rayons d'ombre).
+    template <bool AnyHit = false, typename LeafFn>
+    bool traverse_leaves(const Ray& ray, real t_min, real t_max, LeafFn&& leaf) const {
+        if (nodes.empty()) {
+            return false;
+        }
+
+        TraversalRay traversal_ray(ray);
+
+        // Pile des enfants à visiter: index (ou début de feuille), nombre de primitives et profondeur d'entrée.
+        struct Entry {
+            int child;
+            int count;
+            real t_near;
+        };
+        Entry stack[BVH4_STACK_SIZE];
+        int stack_size = 0;
+        stack[stack_size++] = Entry{0, 0, t_min};
+
+        bool hit_bool = false;
+        while (stack_size > 0) {
+            Entry entry = stack[--stack_size];
+            if (entry.t_near > t_max) {
+                continue;
+            }
+
+            if (entry.count > 0) { // Feuille: intersection avec la géométrie
+                if (leaf(entry.child, entry.child + entry.count, t_max)) {
+                    hit_bool = true;
+                    if (AnyHit) {
+                        return true;
+                    }
+                }
+                continue;
+            }
+
+            const BVH4Node& node = nodes[entry.child];
+            real t_near[BVH4_WIDTH];
+            int mask = intersect_aabb4(node.bounds, traversal_ray, t_min, t_max, t_near);
+
+            // Les enfants touchés sont empilés du plus éloigné au plus proche (tri par insertion).
+            int first = stack_size;
+            for (int i = 0; i < BVH4_WIDTH; i++) {
+                if (!(mask & (1 << i)) || node.child[i] < 0) {
+                    continue;
+                }
+                Entry child{node.child[i], node.count[i], t_near[i]};
+                int j = stack_size++;
+                while (j > first && stack[j - 1].t_near < child.t_near) {
+                    stack[j] = stack[j - 1];
+                    j--;
+                }
+                stack[j] = child;
+            }
+        }
+
+        return hit_bool;
+    }
+
+private:
+    // Crée le noeud BVH4 correspondant au noeud binaire ibinary et ses descendants. Retourne son index.
+    int collapse(const BVHTree& tree, int ibinary);
+};
+
+// Noyau AVX2 (bvh4_avx2.cpp): même calcul que le repli scalaire de intersect_aabb4.
+// bounds pointe sur 4 boîtes en SoA (alignées sur 32 octets); origin, inv_direction et sign sont ceux du TraversalRay.
+int intersect_aabb4_avx2(const real* bounds, const real origin[3], const real inv_direction[3],
+                         const int sign[3], real t_min, real t_max, real t_near[BVH4_WIDTH]);
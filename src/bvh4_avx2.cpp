@@ -0,0 +1,42 @@
+// Compilé avec AVX2 (voir CMakeLists.txt). N'est appelé que si cpu_has_avx2() est vrai.
+//
+// Comme sampler_avx2.cpp, ce fichier n'inclut que des en-têtes sans fonction partagée avec le reste
+// du programme: constants.h (type real et constantes) et simd_avx2.h (réservé aux noyaux AVX2).
+
+#include "constants.h"
+#include "simd_avx2.h"
+
+namespace {
+
+// Test des plans (slab test) du rayon contre 4 boîtes à la fois: un registre SSE en float,
+// un registre AVX en double. Même calcul, dans le même ordre, que intersect_aabb4_scalar (bvh4.cpp).
+template <typename S>
+int intersect_aabb4_simd(const real* bounds, const real origin[3], const real inv_direction[3],
+                         const int sign[3], real t_min, real t_max, real t_near[BVH4_WIDTH]) {
+	typedef typename S::V V;
+	static_assert(S::lanes == BVH4_WIDTH, "une voie par boîte");
+
+	V t_enter = S::set1(t_min);
+	V t_exit = S::set1(t_max);
+
+	for (int axis = 0; axis < 3; axis++) {
+		V o = S::set1(origin[axis]);
+		V inv_d = S::set1(inv_direction[axis]);
+		// Plans d'entrée et de sortie choisis selon le signe de la direction: aucun min/max par paire.
+		V t0 = S::mul(S::sub(S::load(bounds + BVH4_WIDTH * (3 * sign[axis] + axis)), o), inv_d);
+		V t1 = S::mul(S::sub(S::load(bounds + BVH4_WIDTH * (3 * (1 - sign[axis]) + axis)), o), inv_d);
+		// max(a, b) = a > b ? a : b: un NaN (0 * inf) laisse l'intervalle inchangé.
+		t_enter = S::max(t0, t_enter);
+		t_exit = S::min(t1, t_exit);
+	}
+
+	S::storeu(t_near, t_enter);
+	return S::movemask(S::template cmp<_CMP_LE_OQ>(t_enter, t_exit));
+}
+
+}
+
+int intersect_aabb4_avx2(const real* bounds, const real origin[3], const real inv_direction[3],
+                         const int sign[3], real t_min, real t_max, real t_near[BVH4_WIDTH]) {
+	return intersect_aabb4_simd<Simd4<real>>(bounds, origin, inv_direction, sign, t_min, t_max, t_near);
+}
@@ -0,0 +1,48 @@
+#include "camera.h"
+
+CameraRayGenerator::CameraRayGenerator(const Scene& scene)
+{
+	// Base vectors for basis change
+	double3 forward = normalize(scene.camera.center - scene.camera.position);
+	double3 right = normalize(cross(scene.camera.up, forward));
+	double3 up = normalize(cross(right, forward)); // guarantees 90 degree angle for up
+	double3 pos = scene.camera.position;
+
+	// Viewport paramters
+	double FOVy_rads = deg2rad(scene.camera.fovy);
+	double vp_height = tan(FOVy_rads/2)*2; // Assumes distance between camera origin and viewport center is normalized
+	double vp_width = vp_height * scene.camera.aspect; // Assuming aspect ratio is width:height
+
+	// Basis change
+	double4x4 cam_to_world_matrix{
+		{right[0],up[0],forward[0],pos[0]},
+		{right[1],up[1],forward[1],pos[1]},
+		{right[2],up[2],forward[2],pos[2]},
+		{0,0,0,1}};
+	double4x4 world_to_cam_matrix = inverse(cam_to_world_matrix);
+
+	// Un point du plan image (px, py, dist) devient M * (px * sx, py * sy, dist) + t dans le repère global.
+	double sx = vp_width / scene.resolution[0];
+	double sy = vp_height / scene.resolution[1];
+	double dist = length(scene.camera.center - scene.camera.position);
+
+	// Centre du pixel (0,0) décalé du coin inférieur de la zone de jitter.
+	double px0 = -scene.resolution[0]/2 + 0.5 - scene.jitter_radius;
+	double py0 = scene.resolution[1]/2 - 0.5 - scene.jitter_radius;
+
+	origin = pos;
+	du = world_to_cam_matrix[0].xyz() * sx;
+	dv = world_to_cam_matrix[1].xyz() * sy;
+	base = px0 * du + py0 * dv + dist * world_to_cam_matrix[2].xyz() + world_to_cam_matrix[3].xyz() - origin;
+	jitter_scale = 2 * scene.jitter_radius;
+}
+
+void CameraRayGenerator::generate_tile(const Tile& tile, const double2* jitters, Ray* out) const
+{
+	int i = 0;
+	for (int y = tile.y_begin; y < tile.y_end; y++) {
+		for (int x = tile.x_begin; x < tile.x_end; x++, i++) {
+			out[i] = generate(x, y, jitters[i]);
+		}
+	}
+}
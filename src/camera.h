@@ -0,0 +1,44 @@
+#pragma once
+
+#include "basic.h"
+#include "scene.h"
+#include "scheduler.h"
+#include "linalg/linalg.h"
+using namespace linalg::aliases;
+
+// Génère les rayons primaires de la caméra d'une scène.
+//
+// La base de la caméra, la taille du plan image et le changement de repère sont calculés
+// une seule fois à la construction. Chaque rayon est ensuite obtenu par une simple
+// application affine: direction = base + u * du + v * dv, suivie d'une normalisation.
+class CameraRayGenerator
+{
+public:
+    // Précalcule les paramètres de la caméra pour la résolution et le jitter de la scène.
+    CameraRayGenerator(const Scene& scene);
+
+    // Rayon passant par le pixel (x,y), décalé par jitter [entre 0 et 1] à l'intérieur de la zone jitter_radius.
+    Ray generate(int x, int y, double2 jitter) const {
+        double u = x + jitter_scale * jitter[0];
+        double v = -y + jitter_scale * jitter[1];
+        return Ray(real3(origin), real3(normalize(base + u * du + v * dv)));
+    }
+
+    // Génère un rayon par pixel de la tuile (une rangée est une tuile de hauteur 1).
+    // jitters et out sont parcourus ligne par ligne, de gauche à droite.
+    void generate_tile(const Tile& tile, const double2* jitters, Ray* out) const;
+
+private:
+    // Origine commune à tous les rayons primaires.
+    double3 origin;
+
+    // Direction (non normalisée) du coin du plan image associé au pixel (0,0) sans jitter.
+    double3 base;
+
+    // Déplacement de la direction pour un pixel vers la droite / vers le haut.
+    double3 du;
+    double3 dv;
+
+    // Largeur de la zone de jitter en pixels (2 * jitter_radius).
+    double jitter_scale;
+};
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cfloat>
+
+// Type scalaire et constantes partagés par tout le programme, noyaux AVX2 (*_avx2.cpp) compris.
+// Ce fichier ne contient que des typedef et des #define, aucune fonction: l'inclure dans une unité
+// compilée avec AVX2 n'y compile aucun code partagé avec le reste du programme.
+
+// Type scalaire de la géométrie: rayons, AABB, intersections, objets et containers.
+// Avec l'option CMake RAY_SINGLE_PRECISION, la géométrie est en float: deux fois plus de voies par
+// registre vectoriel et des noeuds, boîtes et triangles deux fois plus petits. La double précision
+// reste le mode par défaut (rendus de référence). Les couleurs, l'échantillonnage et les images
+// restent en double dans les deux modes.
+#if defined(RAY_SINGLE_PRECISION)
+typedef float real;
+#define REAL_MAX FLT_MAX
+#else
+typedef double real;
+#define REAL_MAX DBL_MAX
+#endif
+
+#define PI 3.14159265358979323846
+#define EPSILON 1e-6
+
+// Nombre d'enfants d'un noeud BVH4 (et de boîtes d'un AABB4).
+#define BVH4_WIDTH 4
+
+// Nombre de flux du générateur vectoriel (pcg32_8).
+#define SAMPLER_LANES 8
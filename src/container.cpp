@@ -1,5 +1,18 @@
 #include "container.h"
 
+#include <chrono>
+#include <utility>
+
+BVH::BVH(std::vector<Object*> objs, BVHBuildMode mode, BVHCostModel cost, int num_threads) : objects(objs) {
+	std::vector<AABB> aabbs(objects.size());
+	for (size_t iobj = 0; iobj < objects.size(); iobj++) {
+		aabbs[iobj] = objects[iobj]->compute_aabb();
+	}
+
+	tree.build(std::move(aabbs), mode, cost, num_threads);
+	tree.stats.print(std::cout, mode == BVHBuildMode::SAH ? "BVH_SAH" : "BVH", int(objects.size()));
+}
+
 // @@@@@@ VOTRE CODE ICI
 // - Parcourir l'arbre DEPTH FIRST SEARCH selon les conditions suivantes:
 // 		- S'il s'agit d'une feuille, faites l'intersection avec la géométrie.
@@ -7,8 +20,89 @@
 //			- Faites l'intersection du rayon avec le AABB gauche et droite. 
 //				- S'il y a intersection, ajouter le noeud à ceux à visiter. 
 // - Retourner l'intersection avec la profondeur maximale la plus PETITE.
-bool BVH::intersect(Ray ray, double t_min, double t_max, Intersection* hit) {
-	return true;
+bool BVH::intersect(Ray ray, real t_min, real t_max, Intersection* hit) {
+	return tree.traverse(ray, t_min, t_max, [&](int i, real& min_dist) {
+		Intersection tmp;
+		if (objects[tree.indices[i]]->intersect(ray, t_min, min_dist, &tmp) && tmp.depth < min_dist) {
+			min_dist = tmp.depth; // Select new closest depth
+			*hit = tmp;
+			return true;
+		}
+		return false;
+	});
+}
+
+bool BVH::occluded(Ray ray, real t_min, real t_max) {
+	return tree.traverse<true>(ray, t_min, t_max, [&](int i, real&) {
+		return objects[tree.indices[i]]->occluded(ray, t_min, t_max);
+	});
+}
+
+BVH4::BVH4(std::vector<Object*> objs, BVHCostModel cost, int num_threads) : objects(objs) {
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<AABB> aabbs(objects.size());
+	for (size_t iobj = 0; iobj < objects.size(); iobj++) {
+		aabbs[iobj] = objects[iobj]->compute_aabb();
+	}
+
+	BVHTree binary;
+	binary.build(std::move(aabbs), BVHBuildMode::SAH, cost, num_threads);
+	tree.build(binary);
+
+	BVHBuildStats stats = binary.stats;
+	stats.n_nodes = int(tree.nodes.size());
+	stats.peak_bytes += tree.nodes.capacity() * sizeof(BVH4Node);
+	stats.build_milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	stats.print(std::cout, "BVH4", int(objects.size()));
+}
+
+bool BVH4::intersect(Ray ray, real t_min, real t_max, Intersection* hit) {
+	return tree.traverse_leaves(ray, t_min, t_max, [&](int begin, int end, real& min_dist) {
+		bool hit_bool = false;
+		for (int i = begin; i < end; i++) {
+			Intersection tmp;
+			if (objects[tree.indices[i]]->intersect(ray, t_min, min_dist, &tmp) && tmp.depth < min_dist) {
+				min_dist = tmp.depth;
+				*hit = tmp;
+				hit_bool = true;
+			}
+		}
+		return hit_bool;
+	});
+}
+
+bool BVH4::occluded(Ray ray, real t_min, real t_max) {
+	return tree.traverse_leaves<true>(ray, t_min, t_max, [&](int begin, int end, real&) {
+		for (int i = begin; i < end; i++) {
+			if (objects[tree.indices[i]]->occluded(ray, t_min, t_max)) {
+				return true;
+			}
+		}
+		return false;
+	});
+}
+
+Naive::Naive(std::vector<Object*> objs) : objects(objs) {
+	aabbs.resize((objects.size() + BVH4_WIDTH - 1) / BVH4_WIDTH);
+	for (size_t iobj = 0; iobj < aabbs.size() * BVH4_WIDTH; iobj++) {
+		AABB4& packet = aabbs[iobj / BVH4_WIDTH];
+		int lane = int(iobj % BVH4_WIDTH);
+		if (iobj >= objects.size()) {
+			// Voie inutilisée du dernier groupe: boîte vide, jamais touchée.
+			for (int axis = 0; axis < 3; axis++) {
+				packet.bounds[axis][lane] = REAL_MAX;
+				packet.bounds[3 + axis][lane] = -REAL_MAX;
+			}
+			continue;
+		}
+
+		AABB aabb = objects[iobj]->compute_aabb();
+		for (int axis = 0; axis < 3; axis++) {
+			packet.bounds[axis][lane] = aabb.min[axis];
+			packet.bounds[3 + axis][lane] = aabb.max[axis];
+		}
+	}
 }
 
 // @@@@@@ VOTRE CODE ICI
@@ -17,21 +111,44 @@ bool BVH::intersect(Ray ray, double t_min, double t_max, Intersection* hit) {
 //			- Si intersection, détecter l'intersection avec la géométrie.
 //				- Si intersection, mettre à jour les paramètres.
 // - Retourner l'intersection avec la profondeur maximale la plus PETITE.
-bool Naive::intersect(Ray ray, double t_min, double t_max, Intersection* hit) {
+bool Naive::intersect(Ray ray, real t_min, real t_max, Intersection* hit) {
 	bool hit_bool = false;
-	double min_dist = t_max;
+	real min_dist = t_max;
+	TraversalRay traversal_ray(ray);
 
-	for (auto& object : objects){ // Loop through objects
-		Intersection tmp; // Temp intersection
-		if (object->intersect(ray, t_min, min_dist, &tmp)){ // Recursion
-			if (tmp.depth < min_dist){
-				hit_bool = true;
-				min_dist = tmp.depth; // Select new closest depth
-				*hit = tmp;
+	for (size_t ipacket = 0; ipacket < aabbs.size(); ipacket++) { // Loop through objects, 4 at a time
+		// Les boîtes sont testées contre min_dist: les objets plus loin que l'intersection courante sont ignorés.
+		real t_near[BVH4_WIDTH];
+		int mask = intersect_aabb4(aabbs[ipacket].bounds, traversal_ray, t_min, min_dist, t_near);
+		for (int lane = 0; lane < BVH4_WIDTH; lane++) {
+			if (!(mask & (1 << lane))) {
+				continue;
+			}
+			Intersection tmp; // Temp intersection
+			if (objects[ipacket * BVH4_WIDTH + lane]->intersect(ray, t_min, min_dist, &tmp)) { // Recursion
+				if (tmp.depth < min_dist){
+					hit_bool = true;
+					min_dist = tmp.depth; // Select new closest depth
+					*hit = tmp;
+				}
 			}
-			
 		}
 	}
 
 	return hit_bool;
 }
+
+bool Naive::occluded(Ray ray, real t_min, real t_max) {
+	TraversalRay traversal_ray(ray);
+
+	for (size_t ipacket = 0; ipacket < aabbs.size(); ipacket++) {
+		real t_near[BVH4_WIDTH];
+		int mask = intersect_aabb4(aabbs[ipacket].bounds, traversal_ray, t_min, t_max, t_near);
+		for (int lane = 0; lane < BVH4_WIDTH; lane++) {
+			if ((mask & (1 << lane)) && objects[ipacket * BVH4_WIDTH + lane]->occluded(ray, t_min, t_max)) {
+				return true;
+			}
+		}
+	}
+	return false;
+}
@@ -1,10 +1,13 @@
 #pragma once
 
+#include <iostream>
 #include <vector>
 
 #include "object.h"
 #include "basic.h"
 #include "aabb.h"
+#include "bvh.h"
+#include "bvh4.h"
 
 //Interface d'un container pour différente intersection.
 class IContainer {
@@ -13,106 +16,65 @@ public:
 
     // Intersecte le rayon avec l'ensemble des objets dans l'intervalle spécifiée.
     // Retourne vrai s'il y a intersection sinon faux.
-	virtual bool intersect(Ray ray, double t_min, double t_max, Intersection* hit) = 0;
-};
-
-// Structure contenant l'index et le AABB associé.
-// Pratique pour créer l'algorithme de BVH.
-struct BVHObjectInfo {
-    // Index de l'objet
-    int idx;
+	virtual bool intersect(Ray ray, real t_min, real t_max, Intersection* hit) = 0;
 
-    // AABB associé à l'objet
-    AABB aabb;
+    // Retourne vrai si le rayon intersecte au moins un objet dans l'intervalle spécifiée.
+    // S'arrête à la première intersection trouvée et ne calcule aucune information sur celle-ci (rayons d'ombre).
+    virtual bool occluded(Ray ray, real t_min, real t_max) = 0;
 };
 
-// Structure représentant chaque noeud dans l'arbre BVH
-struct BVHNode {
-    // Noeud de gauche
-    BVHNode* left;
-    // Noeud de droite
-    BVHNode* right;
+// Classe contenant la liste d'objet et l'arbre BVH linéarisé sur leurs AABB (voir bvh.h).
+class BVH : virtual public IContainer {
+public:
+    //Liste d'objets représentants tous les objets dans la scène.
+    std::vector<Object*> objects;
+
+    // Arbre BVH sur les objets: tree.indices référence objects.
+    BVHTree tree;
 
-    // AABB englobant les deux neuds.
-    AABB aabb;
+    //Constructeur de BVH qui construit l'arbre sur les AABB des objets avec num_threads fils.
+    BVH(std::vector<Object*> objs, BVHBuildMode mode = BVHBuildMode::Median, BVHCostModel cost = BVHCostModel(),
+        int num_threads = 1);
+    ~BVH() {};
 
-    // Index de l'objet dans la liste
-    int idx;
+    //À adapter pour BVH
+	bool intersect(Ray ray, real t_min, real t_max, Intersection* hit);
+	bool occluded(Ray ray, real t_min, real t_max);
 };
 
-// Classe contenant la liste d'objet et la racine de l'arbre BVH.
-class BVH : virtual public IContainer {
+// BVH à 4 enfants par noeud (container "BVH4"): l'arbre SAH binaire est réduit en un BVH4Tree
+// dont chaque noeud teste les boîtes de ses 4 enfants en un seul test vectoriel (voir bvh4.h).
+class BVH4 : virtual public IContainer {
 public:
     //Liste d'objets représentants tous les objets dans la scène.
     std::vector<Object*> objects;
 
-    // Racine de l'arbre BVH
-    // NOTE UTILE: Si les valeurs de left et right sont nulles, il s'agit d'une feuille.
-    BVHNode* root;
-
-    //Constructeur de BVH qui appelle récursivement recursive_build afin de construire l'arbre.
-    BVH(std::vector<Object*> objs) : objects(objs) {
-        std::vector<BVHObjectInfo> bvhs;
+    // Arbre BVH4 sur les objets: tree.indices référence objects.
+    BVH4Tree tree;
 
-        for (int iobj = 0; iobj < objects.size(); iobj++) {
-            bvhs.push_back({iobj, objects[iobj]->compute_aabb()});
-        }
+    //Constructeur de BVH4 qui construit l'arbre SAH binaire avec num_threads fils puis le réduit.
+    BVH4(std::vector<Object*> objs, BVHCostModel cost = BVHCostModel(), int num_threads = 1);
+    ~BVH4() {};
 
-        root = recursive_build(bvhs, 0, bvhs.size(), 0);
-    };
-    ~BVH() {};
-
-    //À adapter pour BVH
-	bool intersect(Ray ray, double t_min, double t_max, Intersection* hit);
-private:
-
-    // Fonction recursive permettant la construction de notre arbre BVH
-    // On choisit aléatoirement un axe. On trie la liste en fonction de l'axe.
-    // On construit récursivement les autres noeuds également.
-    // On combine le AABB des deux noeuds après récursions.
-    BVHNode* recursive_build(std::vector<BVHObjectInfo> bvhs, int idx_start, int idx_end, int axis) {
-        BVHNode* node = new BVHNode{};
-
-        auto comparator = [=](BVHObjectInfo a, BVHObjectInfo b) {
-            return compare(a.aabb,b.aabb,axis);
-        };
-
-        //s'il y a un seul élément, il s'agit d'une feuille. On arrête la récursion.
-        if (idx_end - idx_start == 1){
-            node->left = node->right = nullptr;
-            node->idx = bvhs[idx_start].idx;
-            node->aabb = bvhs[idx_start].aabb;
-        }
-        // sinon, on parcourt récursivement
-        else {
-            std::sort(bvhs.begin() + idx_start, bvhs.begin() + idx_end, comparator);
-
-            int mid = idx_start + (idx_end - idx_start)/2;
-            node->left = recursive_build(bvhs, idx_start, mid, (axis+1)%3);
-            node->right = recursive_build(bvhs, mid, idx_end, (axis+1)%3);
-            node->aabb = combine(node->left->aabb,node->right->aabb);
-            node->idx = -1;
-        }
-
-        return node;
-    };
+	bool intersect(Ray ray, real t_min, real t_max, Intersection* hit);
+	bool occluded(Ray ray, real t_min, real t_max);
 };
 
+// Container sans structure d'accélération, pour les petites scènes où construire un BVH ne vaut pas la peine.
+// Les AABB des objets sont balayés 4 à la fois (test des plans vectoriel, voir intersect_aabb4);
+// seuls les objets dont la boîte est touchée avant l'intersection la plus proche sont testés exactement.
 class Naive : virtual public IContainer {
 public:
     //Liste d'objets représentants tous les objets dans la scène.
     std::vector<Object*> objects;
-    //Liste de AABB pour chaque objet.
-    std::vector<AABB> aabbs;
+    //Liste de AABB pour chaque objet, en SoA par groupes de 4: l'objet i est la voie i % 4 de aabbs[i / 4].
+    std::vector<AABB4> aabbs;
 
     //Simple constructeur de Naive à partir d'une liste d'objets
-    Naive(std::vector<Object*> objs) : objects(objs) {
-        for (auto obj : objects) {
-            aabbs.push_back(obj->compute_aabb());
-        }
-    }
+    Naive(std::vector<Object*> objs);
     ~Naive() {};
 
     //À adapter pour Naive
-	bool intersect(Ray ray, double t_min, double t_max, Intersection* hit);
+	bool intersect(Ray ray, real t_min, real t_max, Intersection* hit);
+	bool occluded(Ray ray, real t_min, real t_max);
 };
\ No newline at end of file
@@ -0,0 +1,44 @@
+#include "cpu.h"
+
+#include <cstdlib>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace {
+
+bool detect_avx2() {
+#if !defined(RAY_HAS_AVX2_KERNELS)
+	// Aucun noyau AVX2 n'a été compilé pour cette plateforme.
+	return false;
+#elif defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) {
+		return false;
+	}
+
+	// AVX et OSXSAVE (le système sauvegarde les registres YMM).
+	__cpuid(info, 1);
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	bool avx = (info[2] & (1 << 28)) != 0;
+	if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+		return false;
+	}
+
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2");
+#endif
+}
+
+}
+
+bool cpu_has_avx2() {
+	static const bool has_avx2 = std::getenv("RAY_NO_SIMD") == nullptr && detect_avx2();
+	return has_avx2;
+}
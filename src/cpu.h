@@ -0,0 +1,9 @@
+#pragma once
+
+// Détection à l'exécution des jeux d'instructions du processeur.
+// Les noyaux vectoriels sont compilés séparément (voir CMakeLists.txt) et ne sont appelés
+// que si le processeur les supporte; sinon on se rabat sur le code scalaire.
+
+// Vrai si le processeur et le système d'exploitation supportent AVX2.
+// Peut être forcé à faux avec la variable d'environnement RAY_NO_SIMD (comparaisons, débogage).
+bool cpu_has_avx2();
@@ -7,6 +7,8 @@
 #include <iostream>
 #include <cmath>
 #include <cfloat>
+#include <cstdint>
+#include <cstdio>
 
 #include "basic.h"
 
@@ -16,70 +18,103 @@
 
 // Classe qui représente une seule frame.
 // Les coordonnées sont exprimés dans un repere où l'origine est le coin inférieure gauche de l'image.
+//
+// Seul le résultat final de chaque pixel est conservé, en float: la couleur en RGB contigu (3 floats)
+// et la profondeur sur un seul canal, soit 16 octets par pixel. Les accumulations (moyenne des
+// échantillons, z_buffer) restent dans le Raytracer, en double.
 class Frame 
 {
 protected:
     int width, height;
-	double *color;
-    double *depth;
+	std::vector<float> color;
+    std::vector<float> depth;
 
 public:
 	// Construit une frame
-    Frame() : width(0), height(0), color(NULL) {}
+    Frame() : width(0), height(0) {}
 
     // Construit une frame avec les dimensions spécifiées.
-    Frame(int width, int height) : width(width), height(height) 
+    Frame(int width, int height) : width(width), height(height),
+		color(size_t(3) * width * height), depth(size_t(width) * height)
 	{ 
-		color = new double[3 * width * height];
-		depth = new double[3 * width * height];
 	}
 
-    // Destructor.
-	~Frame() { 
-		delete[] color;
-		delete[] depth; }
+	// Mémoire occupée par les pixels de la frame (octets).
+	size_t memory_bytes() const {
+		return (color.size() + depth.size()) * sizeof(float);
+	}
+
+	// Sauvegarde la couleur à l'endroit spécifiée. Retourne faux si le fichier n'a pu être écrit.
+	bool show_color_to(std::string const &filename) const {
+		return show_to(filename, color.data(), 3);
+	}
+
+	// Sauvegarde la profondeur à l'endroit spécifiée (en niveaux de gris). Retourne faux si le fichier n'a pu être écrit.
+	bool show_depth_to(std::string const &filename) const {
+		return show_to(filename, depth.data(), 1);
+	}
 
-	// Sauvegarde la couleur à l'endroit spécifiée.
-	void show_color_to(std::string const &filename) const {
-		show_to(filename, color);
+	// Sauvegarde la couleur en PFM (floats RGB bruts, sans normalisation). Retourne faux si le fichier n'a pu être écrit.
+	bool show_color_pfm_to(std::string const &filename) const {
+		return show_pfm_to(filename, color.data(), 3);
 	}
 
-	// Sauvegarde la profondeur à l'endroit spécifiée.
-	void show_depth_to(std::string const &filename) const {
-		show_to(filename, depth);
+	// Sauvegarde la profondeur en PFM (un float par pixel, sans normalisation). Retourne faux si le fichier n'a pu être écrit.
+	// Le Raytracer y range la profondeur ramenée entre z_near (0) et z_far (1); 1 pour un pixel sans intersection.
+	bool show_depth_pfm_to(std::string const &filename) const {
+		return show_pfm_to(filename, depth.data(), 1);
 	}
 
     // Modifie la couleur du pixel à la coordoonnée x,y
 	void set_color_pixel(int x, int y, double3 color) {
-		int offset = compute_offset(x,y);
+		size_t offset = 3 * compute_offset(x,y);
 
 		for (int i = 0; i < 3; i++) {
-			this->color[offset + i] = color[i];
+			this->color[offset + i] = float(color[i]);
 		}
 	}
 
     // Modifie la profondeur du pixel à la coordoonnée x,y
 	void set_depth_pixel(int x, int y, double gray) { 
-		int offset = compute_offset(x,y);
-
-		for (int i = 0; i < 3; i++) {
-			this->depth[offset + i] = gray;
-		}
+		this->depth[compute_offset(x,y)] = float(gray);
 	}
 
 private:
 	
-	//Calcule le décalage dans le tableau plat.
-	int compute_offset(int x, int y) {
+	//Calcule l'index du pixel dans les tableaux plats (ligne du haut en premier).
+	size_t compute_offset(int x, int y) const {
 		y = height - y - 1;
-		return 3 * (y * width + x);
+		return size_t(y) * width + x;
+	}
+
+	// Écrit values (channels = 3: RGB, channels = 1: gris) en Portable FloatMap: en-tête texte
+	// ("PF" ou "Pf", dimensions, échelle négative pour little-endian) suivi des floats, ligne du bas en premier.
+	bool show_pfm_to(std::string const &filename, const float* values, int channels) const
+	{
+		// L'échelle négative indique des floats little-endian; on écrit dans l'ordre de la machine.
+		const uint16_t probe = 1;
+		bool little_endian = *(const unsigned char*)&probe == 1;
+
+		FILE *f = NULL;
+		f = fopen(filename.c_str(), "wb");
+		if (!f) { puts("can't write output image to disk!"); return false; }
+
+		bool written = fprintf(f, "%s\n%d %d\n%s\n", channels == 3 ? "PF" : "Pf", width, height,
+		                       little_endian ? "-1.0" : "1.0") > 0;
+		size_t row_size = size_t(channels) * width;
+		for (int i = height - 1; i >= 0 && written; i--)	//pfm stores images upside down, comme bmp
+		{
+			written = fwrite(values + row_size * i, sizeof(float), row_size, f) == row_size;
+		}
+		return fclose(f) == 0 && written;
 	}
 
-	void show_to(std::string const &filename, double* values) const
+	// Écrit values (channels = 3: RGB, channels = 1: gris répété sur les 3 canaux) en BMP 24 bits.
+	// Le fichier complet est encodé en mémoire puis écrit en un seul appel à fwrite.
+	bool show_to(std::string const &filename, const float* values, int channels) const
 	{
 		unsigned char bmpfileheader[14] = { 'B', 'M', 0, 0, 0, 0, 0, 0, 0, 0, 54, 0, 0, 0 };
 		unsigned char bmpinfoheader[40] = { 40, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 24, 0 };
-		unsigned char bmppad[3] = { 0, 0, 0 };
 		int filesize = 54 + 3 * width*height;
 
 		bmpfileheader[2] = (unsigned char)(filesize);
@@ -96,50 +131,71 @@ private:
 		bmpinfoheader[10] = (unsigned char)(height >> 16);
 		bmpinfoheader[11] = (unsigned char)(height >> 24);
 
-		double max_intensity = DBL_MIN, min_intensity = DBL_MAX;
-		for (int i = 0; i < 3 * width*height; i++)
+		// Min/max sur les floats (exact). Sans -ffast-math, une réduction sur un seul min/max n'est pas
+		// vectorisée: on garde un min/max partiel par colonne (boucle élément par élément sur chaque ligne,
+		// vectorisée), puis on réduit la ligne de partiels.
+		size_t n_values = size_t(channels) * width*height;
+		size_t n_columns = size_t(channels) * width;
+		std::vector<float> max_columns(n_columns, -FLT_MAX), min_columns(n_columns, FLT_MAX);
+		for (int i = 0; i < height; i++)
 		{
-			max_intensity = std::max(max_intensity,values[i]);
-			min_intensity = std::min(min_intensity,values[i]);
+			const float* row = values + n_columns * i;
+			for (size_t k = 0; k < n_columns; k++)
+			{
+				max_columns[k] = row[k] > max_columns[k] ? row[k] : max_columns[k];
+				min_columns[k] = row[k] < min_columns[k] ? row[k] : min_columns[k];
+			}
 		}
-
-		FILE *f = NULL;
-		f = fopen(filename.c_str(), "wb");
-		if (!f) { puts("can't write output image to disk!"); return; }
-
-		fwrite(bmpfileheader, 1, 14, f);
-		fwrite(bmpinfoheader, 1, 40, f);
-		unsigned char offsetBuf = 0;
-		long lineOffset = width * 3 % 4;
-		if (lineOffset != 0)
+		float max_value = -FLT_MAX, min_value = FLT_MAX;
+		for (size_t k = 0; k < n_columns; k++)
 		{
-			lineOffset = 4 - lineOffset;
+			max_value = max_columns[k] > max_value ? max_columns[k] : max_value;
+			min_value = min_columns[k] < min_value ? min_columns[k] : min_value;
 		}
-		unsigned char mapped_intensity;
+		double max_intensity = std::max(DBL_MIN, double(max_value));
+		double min_intensity = n_values ? double(min_value) : DBL_MAX;
+		double range = max_intensity - min_intensity;
+
+		// Chaque ligne est complétée à un multiple de 4 octets.
+		size_t row_size = 3 * size_t(width);
+		size_t line_offset = (4 - row_size % 4) % 4;
+		std::vector<unsigned char> buffer(54 + (row_size + line_offset) * height, 0);
+		std::copy(bmpfileheader, bmpfileheader + 14, buffer.begin());
+		std::copy(bmpinfoheader, bmpinfoheader + 40, buffer.begin() + 14);
+
+		// Intensités d'une ligne, dans l'ordre de values.
+		std::vector<unsigned char> mapped(size_t(channels) * width);
+
+		// Canaux rouge, vert et bleu d'un pixel (le même pour une image en gris).
+		int r = 0, g = channels > 1 ? 1 : 0, b = channels > 2 ? 2 : 0;
+
+		unsigned char* out = buffer.data() + 54;
 		for (int i = height - 1; i >= 0; i--)	//bmp stores images upside down
 		{
-			for (int j = 0; j<width; j++)
+			//!!! maybe a better tone mapping algorithm
+			// Boucle contiguë sans dépendance entre les éléments: vectorisée par le compilateur.
+			const float* row = values + size_t(channels) * i * width;
+			for (size_t k = 0; k < mapped.size(); k++)
 			{
-				int start = 3 * (i*width + j);
-				
-				//!!! maybe a better tone mapping algorithm
-				mapped_intensity = (unsigned char)((values[start + 2] - min_intensity) / (max_intensity - min_intensity) * 255);
-				//mapped_intensity = (unsigned char)(max(0.0, min(1.0, color[start + 2] / 16)) * 255);
-				fwrite(&mapped_intensity, 1, 1, f);
-
-				mapped_intensity = (unsigned char)((values[start + 1] - min_intensity) / (max_intensity - min_intensity) * 255);
-				//mapped_intensity = (unsigned char)(max(0.0, min(1.0, color[start + 1] / 16)) * 255);
-				fwrite(&mapped_intensity, 1, 1, f);
-
-				mapped_intensity = (unsigned char)((values[start] - min_intensity) / (max_intensity - min_intensity) * 255);
-				//mapped_intensity = (unsigned char)(max(0.0, min(1.0, color[start] / 16)) * 255);
-				fwrite(&mapped_intensity, 1, 1, f);
+				mapped[k] = (unsigned char)((row[k] - min_intensity) / range * 255);
 			}
 
-			fwrite(&offsetBuf, 1, lineOffset, f);
+			for (int j = 0; j < width; j++)
+			{
+				const unsigned char* pixel = &mapped[size_t(channels) * j];
+				out[3 * j + 0] = pixel[b];
+				out[3 * j + 1] = pixel[g];
+				out[3 * j + 2] = pixel[r];
+			}
+			out += row_size + line_offset;
 		}
 
-		fclose(f);
+		FILE *f = NULL;
+		f = fopen(filename.c_str(), "wb");
+		if (!f) { puts("can't write output image to disk!"); return false; }
+
+		bool written = fwrite(buffer.data(), 1, buffer.size(), f) == buffer.size();
+		return fclose(f) == 0 && written;
 	}
 
 };
\ No newline at end of file
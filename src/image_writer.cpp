@@ -0,0 +1,83 @@
+#include "image_writer.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+ImageWriter::ImageWriter() {
+	worker = std::thread(&ImageWriter::run, this);
+}
+
+ImageWriter::~ImageWriter() {
+	finish();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	job_ready.notify_one();
+	worker.join();
+}
+
+void ImageWriter::save(Frame frame, const std::filesystem::path& directory) {
+	std::shared_ptr<const Frame> shared = std::make_shared<const Frame>(std::move(frame));
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		jobs.push_back(Job{shared, false, false, (directory / "color.bmp").string()});
+		jobs.push_back(Job{shared, true, false, (directory / "depth.bmp").string()});
+		jobs.push_back(Job{shared, false, true, (directory / "color.pfm").string()});
+		jobs.push_back(Job{shared, true, true, (directory / "depth.pfm").string()});
+	}
+	job_ready.notify_one();
+}
+
+int ImageWriter::finish() {
+	std::unique_lock<std::mutex> lock(mutex);
+	idle.wait(lock, [this] { return jobs.empty() && !busy; });
+	return n_failed;
+}
+
+void ImageWriter::run() {
+	std::unique_lock<std::mutex> lock(mutex);
+	while (true) {
+		job_ready.wait(lock, [this] { return stopping || !jobs.empty(); });
+		if (jobs.empty()) {
+			return;
+		}
+
+		Job job = std::move(jobs.front());
+		jobs.pop_front();
+		busy = true;
+		lock.unlock();
+
+		auto start = std::chrono::steady_clock::now();
+		bool written;
+		if (job.pfm) {
+			written = job.depth ? job.frame->show_depth_pfm_to(job.filename) : job.frame->show_color_pfm_to(job.filename);
+		}
+		else {
+			written = job.depth ? job.frame->show_depth_to(job.filename) : job.frame->show_color_to(job.filename);
+		}
+		double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		// La frame est libérée dès que sa dernière image est écrite.
+		job.frame.reset();
+
+		// Ligne complète en un seul appel: le fil principal peut écrire sur std::cout en même temps.
+		std::ostringstream line;
+		if (written) {
+			line << "Saved " << job.filename << " (" << ms << " ms)\n";
+		}
+		else {
+			line << "Failed to save " << job.filename << "\n";
+		}
+		std::cout << line.str() << std::flush;
+
+		lock.lock();
+		busy = false;
+		if (!written) {
+			n_failed++;
+		}
+		if (jobs.empty()) {
+			idle.notify_all();
+		}
+	}
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "frame.h"
+
+// Écrit les images des frames rendues sur un fil dédié.
+//
+// save() prend possession de la frame et retourne immédiatement: l'encodage (min/max, conversion en BMP)
+// et l'écriture sur disque se font pendant que le fil appelant rend la scène suivante.
+// Les fichiers sont écrits dans l'ordre où ils ont été demandés; chacun est annoncé sur std::cout
+// lorsqu'il est terminé (ou en échec).
+class ImageWriter {
+public:
+    // Lance le fil d'écriture.
+    ImageWriter();
+
+    // Attend que toutes les images demandées soient écrites.
+    ~ImageWriter();
+
+    ImageWriter(const ImageWriter&) = delete;
+    ImageWriter& operator=(const ImageWriter&) = delete;
+
+    // Demande l'écriture de la couleur et de la profondeur de frame dans directory: color.bmp et depth.bmp
+    // (normalisées sur 8 bits) ainsi que color.pfm et depth.pfm (floats bruts, pour le post-traitement).
+    void save(Frame frame, const std::filesystem::path& directory);
+
+    // Bloque jusqu'à ce que toutes les images demandées soient écrites. Retourne le nombre d'échecs.
+    int finish();
+
+private:
+    // Une image à écrire. La frame est partagée par toutes ses images (couleur et profondeur, BMP et PFM).
+    struct Job {
+        std::shared_ptr<const Frame> frame;
+        bool depth;
+        // Vrai pour le PFM, faux pour le BMP.
+        bool pfm;
+        std::string filename;
+    };
+
+    void run();
+
+    std::mutex mutex;
+    // Signale une nouvelle image (ou l'arrêt) au fil d'écriture.
+    std::condition_variable job_ready;
+    // Signale à finish() que la file est vide.
+    std::condition_variable idle;
+
+    std::deque<Job> jobs;
+    // Vrai pendant que le fil d'écriture traite une image retirée de jobs.
+    bool busy = false;
+    bool stopping = false;
+    int n_failed = 0;
+
+    std::thread worker;
+};
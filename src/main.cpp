@@ -16,49 +16,66 @@
 
 #include "parser.h"
 #include "raytracer.h"
+#include "image_writer.h"
+#include "resource_manager.h"
 namespace fs = std::filesystem;
 
 int main(int argc, char **argv)
 {	
 	//[0]: cmd
-	//[1]: scene filename
+	//[1..]: scene filenames, rendues l'une après l'autre
 
-	if (!(argc == 2)) {
-		std::cerr << "Entry must respect the following: cmd scene_filename";
+	if (argc < 2) {
+		std::cerr << "Entry must respect the following: cmd scene_filename [scene_filename ...]";
 		return 0;
 	}
 
 	fs::path data_root("data");
 
-    // Non de fichier de scène spécifié
-	fs::path filename_scene_input = data_root / "scene" / std::string(argv[1]);
-	fs::path directory_scene_output = data_root / "output" / filename_scene_input.stem();
+	// Les images sont encodées et écrites sur un autre fil pendant le rendu de la scène suivante.
+	ImageWriter writer;
 
-	if (!fs::exists(directory_scene_output)) {
-		fs::create_directories(directory_scene_output);
-	}
+	for (int iscene = 1; iscene < argc; iscene++) {
+		// Non de fichier de scène spécifié
+		fs::path filename_scene_input = data_root / "scene" / std::string(argv[iscene]);
+		fs::path directory_scene_output = data_root / "output" / filename_scene_input.stem();
 
-    std::cout << "Rendering " << filename_scene_input << std::endl;
-    std::cout << "Output to " << directory_scene_output << std::endl;
+		if (!fs::exists(directory_scene_output)) {
+			fs::create_directories(directory_scene_output);
+		}
+
+		std::cout << "Rendering " << filename_scene_input << std::endl;
+		std::cout << "Output to " << directory_scene_output << std::endl;
+
+		// Analyse le fichier de la scène
+		// Le Lexer ne possède pas le flux: il vit le temps de l'itération.
+		std::ifstream scene_input(filename_scene_input.string().c_str());
+		Parser parser(&scene_input);
+		if (!parser.parse()) {
+			std::cout << "Scene is not found or can't be parsed." << std::endl;
+			ResourceManager::Release();
+			continue;
+		}
 
-	// Analyse le fichier de la scène
-	Parser parser(new std::ifstream(filename_scene_input.string().c_str()));
-	if (!parser.parse()) {
-		std::cout << "Scene is not found or can't be parsed." << std::endl;
-	}
-	else
-	{	
 		Frame output = Frame{parser.scene.resolution[0], parser.scene.resolution[1]};
+		std::cout << "Frame " << parser.scene.resolution[0] << "x" << parser.scene.resolution[1] << ": "
+		          << output.memory_bytes() / (1024.0 * 1024.0) << " MB" << std::endl;
 
 		// Rend la scène donnée avec le lancer de rayon
 		Raytracer raytracer;
 		raytracer.render(parser.scene, &output);
 
-		// Sauvegarde la frame
-		output.show_color_to( (directory_scene_output / "color.bmp").string().c_str() );
-		output.show_depth_to( (directory_scene_output / "depth.bmp").string().c_str() );
+		// Sauvegarde la frame (en arrière-plan)
+		writer.save(std::move(output), directory_scene_output);
+
+		std::cout << "Ray tracing finished for " << filename_scene_input << "." << std::endl;
+
+		// Matériaux et textures sont propres à chaque scène: la scène suivante repart d'un gestionnaire vide.
+		ResourceManager::Release();
+	}
 
-		std::cout << "Ray tracing finished with images saved." << std::endl;
+	if (writer.finish() == 0) {
+		std::cout << "All images saved." << std::endl;
 	}
 	
 	// Décommentez si vous utilisez Visual Studio
@@ -1,7 +1,9 @@
 #include "object.h"
 
+#include <utility>
+
 // Fonction retournant soit la valeur v0 ou v1 selon le signe.
-int rsign(double value, double v0, double v1) {
+int rsign(real value, real v0, real v1) {
 	return (int(std::signbit(value)) * (v1-v0)) + v0;
 }
 
@@ -12,64 +14,62 @@ int rsign(double value, double v0, double v1) {
 //
 // Pour plus de d'informations sur la géométrie, référez-vous à la classe object.h.
 bool Sphere::local_intersect(Ray ray, 
-							 double t_min, double t_max, 
+							 real t_min, real t_max, 
 							 Intersection *hit) 
 {	
 
 	// Interesction formula taken from: https://math.stackexchange.com/questions/1939423/calculate-if-vector-intersects-sphere
-	// Q = P - C = P because C = (0,0,0)
-	double a = length2(ray.direction);
-	double b = 2 * dot(ray.direction, ray.origin);
-	double c = length2(ray.origin) - radius*radius;
-	double discriminant = b*b - 4*a*c;
-
-	if (length(ray.origin)<=radius){ // Ray starts from inside sphere
+	real t;
+	if (!intersect_surface(ray, t_min, t_max, &t)) {
 		return false;
 	}
 
-	if (discriminant<0){ // No intersection
+	hit->position = ray.origin + ray.direction*t;
+	hit->depth = t;
+	hit->normal = normalize(hit->position);
+	return true;
+}
+
+// Occlusion: même test que local_intersect, sans remplir d'Intersection.
+bool Sphere::local_occluded(Ray ray, real t_min, real t_max)
+{
+	real t;
+	return intersect_surface(ray, t_min, t_max, &t);
+}
+
+// Racine la plus proche dans ]t_min, t_max[. Un rayon qui part de l'intérieur de la sphère ne l'intersecte pas.
+bool Sphere::intersect_surface(const Ray& ray, real t_min, real t_max, real* t) const
+{
+	// Q = P - C = P because C = (0,0,0)
+	real a = length2(ray.direction);
+	real b = 2 * dot(ray.direction, ray.origin);
+	real c = length2(ray.origin) - radius*radius;
+	real discriminant = b*b - 4*a*c;
+
+	if (c <= 0 || discriminant < 0) { // Ray starts from inside sphere, or no intersection
 		return false;
 	}
 
-	else if (discriminant == 0){ // 1 intersection point
-		// Quadratic formula
-		double t = (-b + sqrt(discriminant))/(2*a);
-		if (t > t_min && t < t_max){
-			hit->position = ray.origin + ray.direction*t;
-			hit->depth = t;
-			hit->normal = normalize(hit->position);
-		}
+	// Quadratic formula: t_near <= t_far
+	real root = sqrt(discriminant);
+	real t_near = (-b - root)/(2*a);
+	real t_far = (-b + root)/(2*a);
+	if (t_near > t_min && t_near < t_max) {
+		*t = t_near;
 		return true;
 	}
-
-	else{ // 2 intersection points
-		// Quadratic formula
-		double t1 = (-b + sqrt(discriminant))/(2*a); 
-		double t2 = (-b - sqrt(discriminant))/(2*a);
-
-		// Set hit parameters
-		if (t1 > t_min && t1 < t_max){
-			hit->position = ray.origin + ray.direction*t1;
-			hit->depth = t1;
-			hit->normal = normalize(hit->position);
-		}
-
-		// Only do this if t1 fails as t1 always smaller than t2
-		else if (t2 > t_min && t1 < t_max){
-			hit->position = ray.origin + ray.direction*t2;
-			hit->depth = t2;
-			hit->normal = normalize(hit->position);
-		}
-
+	if (t_far > t_min && t_far < t_max) {
+		*t = t_far;
 		return true;
 	}
+	return false;
 }
 
 // @@@@@@ VOTRE CODE ICI
 // Occupez-vous de compléter cette fonction afin de calculer le AABB pour la sphère.
 // Il faut que le AABB englobe minimalement notre objet à moins que l'énoncé prononce le contraire (comme ici).
 AABB Sphere::compute_aabb() {
-	return Object::compute_aabb();
+	return transform_aabb(AABB{real3{-radius, -radius, -radius}, real3{radius, radius, radius}});
 }
 
 // @@@@@@ VOTRE CODE ICI
@@ -79,37 +79,53 @@ AABB Sphere::compute_aabb() {
 //
 // Pour plus de d'informations sur la géométrie, référez-vous à la classe object.h.
 bool Quad::local_intersect(Ray ray, 
-							double t_min, double t_max, 
+							real t_min, real t_max, 
 							Intersection *hit)
 {
 	// Source: https://www.scratchapixel.com/lessons/3d-basic-rendering/minimal-ray-tracer-rendering-simple-shapes/ray-plane-and-ray-disk-intersection.html
 
-	double3 normal{0,0,1}; // Z+
-	double denom = dot(normal, ray.direction);
+	real3 normal{0,0,1}; // Z+
+	real t;
+	if (!intersect_square(ray, t_min, t_max, &t)) {
+		return false;
+	}
 
-	if (denom > EPSILON){ // Ray and square not perpendicular
-		double t = dot(ray.origin, normal)/denom;
+	hit->position = ray.origin + t*ray.direction;
+	hit->depth = t;
+	// Le quad est visible des deux côtés: la normale fait face au rayon.
+	hit->normal = ray.direction.z < 0 ? normal : -normal;
+	return true;
+}
 
-		if (t>t_min && t>t_max){
-			double3 p = ray.origin + t*ray.direction; // Intersection on plane
-			if (abs(p[0])<half_size && abs(p[1])<half_size){ // Intersects
-				hit->position =p;
-				hit->depth = t;
-				hit->normal = normal;
-				return true;
-			}
-		}
+// Occlusion: même test que local_intersect, sans remplir d'Intersection.
+bool Quad::local_occluded(Ray ray, real t_min, real t_max)
+{
+	real t;
+	return intersect_square(ray, t_min, t_max, &t);
+}
+
+// Intersection avec le plan z = 0 à l'intérieur du carré, peu importe le côté touché.
+bool Quad::intersect_square(const Ray& ray, real t_min, real t_max, real* t) const
+{
+	if (fabs(ray.direction.z) < EPSILON) { // Rayon parallèle au plan
+		return false;
 	}
-	
-	return false;
+
+	*t = -ray.origin.z / ray.direction.z;
+	if (*t <= t_min || *t >= t_max) {
+		return false;
+	}
+
+	real3 p = ray.origin + *t*ray.direction;
+	return fabs(p.x) <= half_size && fabs(p.y) <= half_size;
 }
 
 // @@@@@@ VOTRE CODE ICI
 // Occupez-vous de compléter cette fonction afin de calculer le AABB pour le quad (rectangle).
 // Il faut que le AABB englobe minimalement notre objet à moins que l'énoncé prononce le contraire.
 AABB Quad::compute_aabb() {
-	return Object::compute_aabb();
-	//return Object::compute_aabb();
+	// Le quad est plat en Z: on lui donne une épaisseur de EPSILON afin que le AABB ne soit pas dégénéré.
+	return transform_aabb(AABB{real3{-half_size, -half_size, -EPSILON}, real3{half_size, half_size, EPSILON}});
 }
 
 // @@@@@@ VOTRE CODE ICI
@@ -119,118 +135,86 @@ AABB Quad::compute_aabb() {
 //
 // Pour plus de d'informations sur la géométrie, référez-vous à la classe object.h.
 bool Cylinder::local_intersect(Ray ray, 
-							   double t_min, double t_max, 
+							   real t_min, real t_max, 
 							   Intersection *hit)
 {	// Source = https://stackoverflow.com/questions/73866852/ray-cylinder-intersection-formula
-
-	double3 C = {0,half_height,0};
-	double3 V = {0,-1,0};
-
-	// Cylinder cap params
-	double3 normal{0,1,0};
-	double denom = dot(normal, ray.direction);
-	
-	// Cylinder side params
-	double a = length2(ray.direction) - pow(dot(ray.direction,V),2);
-	double b = 2*(dot(ray.direction,ray.origin) - dot(ray.direction,V)*dot(ray.origin,V));
-	double c = length2(ray.origin) - pow(dot(ray.origin,V),2) - pow(radius,2);
-	double discriminant = b*b - 4*a*c;
-
-	bool intersects = false;
-	double t=t_max;
-
-	if (abs(ray.origin[1])<=half_height && sqrt(pow(ray.origin[0],2)+pow(ray.origin[2],2))<=radius){ // Ray origin inside cylinder
+	real t;
+	real3 normal;
+	if (!intersect_surface(ray, t_min, t_max, &t, &normal)) {
 		return false;
 	}
 
-	if (denom>EPSILON){ // Intersection with cylinder caps
-		// Top cap
-		double3 CR0 = C - ray.origin;
-		t = dot(CR0, normal)/denom;
-
-		if (t>t_min && t<t_max){
-			intersects = true;
-			hit->position = ray.origin + ray.direction*t;
-			hit->depth = t;
-			hit->normal = normal;
-		}
+	hit->position = ray.origin + ray.direction*t;
+	hit->depth = t;
+	hit->normal = normal;
+	return true;
+}
 
-		//Bottom cap
-		CR0 = -C - ray.origin;
-		double tmp_t = dot(CR0, -normal)/denom;
+// Occlusion: même test que local_intersect, sans remplir d'Intersection.
+bool Cylinder::local_occluded(Ray ray, real t_min, real t_max)
+{
+	real t;
+	real3 normal;
+	return intersect_surface(ray, t_min, t_max, &t, &normal);
+}
 
-		if (tmp_t>t_min && tmp_t<t_max && tmp_t<t){
-			t = tmp_t;
-			intersects = true;
-			hit->position = ray.origin + ray.direction*t;
-			hit->depth = t;
-			hit->normal = -normal;
-		}
-	}
+// Intersection la plus proche dans ]t_min, t_max[ avec la surface latérale (x^2 + z^2 = r^2, |y| <= half_height)
+// ou l'un des deux couvercles, touchés d'un côté comme de l'autre.
+// Un rayon qui part de l'intérieur du cylindre ne l'intersecte pas.
+bool Cylinder::intersect_surface(const Ray& ray, real t_min, real t_max, real* t, real3* normal) const
+{
+	real3 o = ray.origin;
+	real3 d = ray.direction;
 
-	// Cylinder side
-	if (discriminant<0){ // No intersections
-		return intersects;
+	if (fabs(o.y) <= half_height && o.x*o.x + o.z*o.z <= radius*radius) { // Ray origin inside cylinder
+		return false;
 	}
 
-	else if (discriminant == 0){ // 1 intersection point
-		// Quadratic formula
-		double tmp_t = (-b + sqrt(discriminant))/(2*a);
-		double3 hit_pos = ray.origin + ray.direction*tmp_t;
-
-		if (abs(hit_pos[1])<=half_height){ // Hit is on cylinder
-			if (tmp_t > t_min && tmp_t < t_max && tmp_t<t){
-				t = tmp_t;
+	bool intersects = false;
+	*t = t_max;
+
+	// Surface latérale
+	real a = d.x*d.x + d.z*d.z;
+	real b = 2*(o.x*d.x + o.z*d.z);
+	real c = o.x*o.x + o.z*o.z - radius*radius;
+	real discriminant = b*b - 4*a*c;
+	if (a > 0 && discriminant >= 0) {
+		real root = sqrt(discriminant);
+		real roots[2] = {(-b - root)/(2*a), (-b + root)/(2*a)};
+		for (real t_side : roots) {
+			real3 p = o + t_side*d;
+			if (t_side > t_min && t_side < *t && fabs(p.y) <= half_height) {
+				*t = t_side;
+				*normal = normalize(real3{p.x, 0, p.z});
 				intersects = true;
-				hit->position = ray.origin + ray.direction*t;
-				hit->depth = t;
-				normal = {hit_pos[0],0,hit_pos[2]};
-				hit->normal = normalize(normal);
 			}
 		}
-
-		
 	}
 
-	else if (discriminant > 0){ // 2 intersection points
-		// Quadratic formula
-		double t1 = (-b + sqrt(discriminant))/(2*a); 
-		double t2 = (-b - sqrt(discriminant))/(2*a);
-
-		// t1
-		double3 hit_pos = ray.origin + ray.direction*t1;
-		if (abs(hit_pos[1])<=half_height){ // Hit is on cylinder
-			if (t1 > t_min && t1 < t_max && t1<t){
-				t = t1;
-				intersects = true;
-				hit->position = ray.origin + ray.direction*t;
-				hit->depth = t;
-				normal = {hit_pos[0],0,hit_pos[2]};
-				hit->normal = normalize(normal);
-			}
-		}
-
-		// t2
-		hit_pos = ray.origin + ray.direction*t2;
-		if (abs(hit_pos[1])<=half_height){ // Hit is on cylinder
-			if (t2 > t_min && t2 < t_max && t2<t){
-				t = t2;
-				intersects = true;
-				hit->position = ray.origin + ray.direction*t;
-				hit->depth = t;
-				normal = {hit_pos[0],0,hit_pos[2]};
-				hit->normal = normalize(normal);
+	// Couvercles y = +half_height et y = -half_height
+	if (fabs(d.y) > EPSILON) {
+		for (real cap : {half_height, -half_height}) {
+			real t_cap = (cap - o.y) / d.y;
+			if (t_cap > t_min && t_cap < *t) {
+				real x = o.x + t_cap*d.x;
+				real z = o.z + t_cap*d.z;
+				if (x*x + z*z <= radius*radius) {
+					*t = t_cap;
+					*normal = real3{0, cap > 0 ? real(1) : real(-1), 0};
+					intersects = true;
+				}
 			}
 		}
 	}
-    return intersects;
+
+	return intersects;
 }
 
 // @@@@@@ VOTRE CODE ICI
 // Occupez-vous de compléter cette fonction afin de calculer le AABB pour le cylindre.
 // Il faut que le AABB englobe minimalement notre objet à moins que l'énoncé prononce le contraire (comme ici).
 AABB Cylinder::compute_aabb() {
-	return Object::compute_aabb();
+	return transform_aabb(AABB{real3{-radius, -half_height, -radius}, real3{radius, half_height, radius}});
 }
 
 // @@@@@@ VOTRE CODE ICI
@@ -241,23 +225,28 @@ AABB Cylinder::compute_aabb() {
 // Pour plus de d'informations sur la géométrie, référez-vous à la classe object.h.
 //
 bool Mesh::local_intersect(Ray ray,  
-						   double t_min, double t_max, 
+						   real t_min, real t_max, 
 						   Intersection* hit)
 {
-	bool hit_bool = false;
-	double min_dist = DBL_MAX;
-
-	// Loop through triangles and set the intersection depth to the nearest one
-	// See container.cpp
-	for (auto& triangle: triangles){
-		Intersection tmp;
-		if (intersect_triangle(ray, t_min, min_dist, triangle, &tmp)){
-			if (tmp.depth<min_dist){
-				min_dist = tmp.depth;
-				hit_bool = true;
-				*hit = tmp;
-			}
+	real min_dist = REAL_MAX;
+
+	// Parcours du BVH des triangles dans le repère local: seules les feuilles touchées sont testées,
+	// tous les triangles d'une feuille à la fois (noyau AVX2 si disponible).
+	int hit_triangle = -1;
+	bool hit_bool = bvh.traverse_leaves(ray, t_min, t_max, [&](int begin, int end, real& max_dist) {
+		int itri = store.intersect_range(begin, end, ray, t_min, &max_dist);
+		if (itri >= 0) {
+			min_dist = max_dist;
+			hit_triangle = itri;
+			return true;
 		}
+		return false;
+	});
+
+	// Les informations de l'intersection ne sont calculées que pour le triangle le plus proche.
+	if (hit_bool) {
+		hit->position = ray.origin + ray.direction*min_dist;
+		hit->normal = store.normal(hit_triangle);
 	}
 
 	hit->depth = min_dist;
@@ -269,14 +258,14 @@ bool Mesh::local_intersect(Ray ray,
 // Occupez-vous de compléter cette fonction afin de trouver l'intersection avec un triangle.
 // S'il y a intersection, remplissez hit avec l'information sur la normale et les coordonnées texture.
 bool Mesh::intersect_triangle(Ray  ray, 
-							  double t_min, double t_max,
+							  real t_min, real t_max,
 							  Triangle const tri,
 							  Intersection *hit)
 {
 	// Extrait chaque position de sommet des données du maillage.
-	double3 const &p0 = positions[tri[0].pi]; // ou Sommet A (Pour faciliter les explications)
-	double3 const &p1 = positions[tri[1].pi]; // ou Sommet B
-	double3 const &p2 = positions[tri[2].pi]; // ou Sommet C
+	real3 const &p0 = positions[tri[0].pi]; // ou Sommet A (Pour faciliter les explications)
+	real3 const &p1 = positions[tri[1].pi]; // ou Sommet B
+	real3 const &p2 = positions[tri[2].pi]; // ou Sommet C
 
 	// Triangle en question. Respectez la convention suivante pour vos variables.
 	//
@@ -299,45 +288,45 @@ bool Mesh::intersect_triangle(Ray  ray,
 	// Source: https://www.scratchapixel.com/lessons/3d-basic-rendering/ray-tracing-rendering-a-triangle/ray-triangle-intersection-geometric-solution.html
 
 	// Compute normal
-	double3 p0p1 = p1 - p0;
-	double3 p0p2 = p2 - p0;
-	double3 normal = cross(p0p1, p0p2);
-	double area2 = length(normal);
+	real3 p0p1 = p1 - p0;
+	real3 p0p2 = p2 - p0;
+	real3 normal = cross(p0p1, p0p2);
+	real area2 = length(normal);
 
 	// Check if ray and plane are parallel
-	double n_dot_raydir = dot(normal, ray.direction);
+	real n_dot_raydir = dot(normal, ray.direction);
 	if (fabs(n_dot_raydir) < EPSILON){
 		return false; // Parallel
 	}
 
 	// Calculate d and t
-	double d = -dot(normal, p0);
-	double t = -(dot(normal, ray.origin) + d) / n_dot_raydir;
+	real d = -dot(normal, p0);
+	real t = -(dot(normal, ray.origin) + d) / n_dot_raydir;
 
 	// Check if triangle is behind ray
 	if (t<0) return false;
 
 	// Calculate intersection point
-	double3 P = ray.origin + t*ray.direction;
+	real3 P = ray.origin + t*ray.direction;
 
 	// Inside-Out tests
-	double3 C;
+	real3 C;
 
 	// Edge 0
-	double3 edge0 = p1 - p0;
-	double3 pp0 = P - p0;
+	real3 edge0 = p1 - p0;
+	real3 pp0 = P - p0;
 	C = cross(edge0, pp0);
 	if (dot(normal,C)<0) return false; // P is on the right side
 
 	// Edge 1
-	double3 edge1 = p2 - p1;
-	double3 pp1 = P - p1;
+	real3 edge1 = p2 - p1;
+	real3 pp1 = P - p1;
 	C = cross(edge1, pp1);
 	if (dot(normal,C)<0) return false; // P is on the right side
 
 	// Edge 2
-	double3 edge2 = p0 - p2;
-	double3 pp2 = P - p2;
+	real3 edge2 = p0 - p2;
+	real3 pp2 = P - p2;
 	C = cross(edge2, pp2);
 	if (dot(normal,C)<0) return false;
 
@@ -352,9 +341,46 @@ bool Mesh::intersect_triangle(Ray  ray,
 	return false; // t out of range 
 }
 
+// Occlusion: le parcours s'arrête à la première feuille qui contient un triangle intersecté.
+bool Mesh::local_occluded(Ray ray, real t_min, real t_max)
+{
+	return bvh.traverse_leaves<true>(ray, t_min, t_max, [&](int begin, int end, real& max_dist) {
+		return store.intersect_range(begin, end, ray, t_min, &max_dist) >= 0;
+	});
+}
+
+void Mesh::build_bvh(int num_threads) {
+	std::vector<AABB> aabbs(triangles.size());
+	for (size_t itri = 0; itri < triangles.size(); itri++) {
+		const Triangle& tri = triangles[itri];
+		AABB aabb = construct_aabb({positions[tri[0].pi], positions[tri[1].pi], positions[tri[2].pi]});
+		// Un triangle parallèle à un axe a un AABB plat: on l'épaissit comme pour le Quad.
+		aabbs[itri] = AABB{aabb.min - real(EPSILON), aabb.max + real(EPSILON)};
+	}
+
+	bvh.build(std::move(aabbs), BVHBuildMode::SAH, BVHCostModel(), num_threads);
+
+	// Les feuilles référencent directement triangles: on évite ainsi une indirection lors du parcours.
+	std::vector<Triangle> ordered;
+	ordered.reserve(triangles.size());
+	for (int itri : bvh.indices) {
+		ordered.push_back(triangles[itri]);
+	}
+	triangles.swap(ordered);
+	std::vector<int>().swap(bvh.indices);
+
+	for (const Triangle& tri : triangles) {
+		store.push_back(positions[tri[0].pi], positions[tri[1].pi], positions[tri[2].pi]);
+	}
+}
+
 // @@@@@@ VOTRE CODE ICI
 // Occupez-vous de compléter cette fonction afin de calculer le AABB pour le Mesh.
 // Il faut que le AABB englobe minimalement notre objet à moins que l'énoncé prononce le contraire.
 AABB Mesh::compute_aabb() {
-	return Object::compute_aabb();
+	if (positions.empty()) {
+		return Object::compute_aabb();
+	}
+
+	return transform_aabb(construct_aabb(positions));
 }
\ No newline at end of file
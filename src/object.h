@@ -8,12 +8,17 @@
 #include <cmath>
 #include <cfloat>
 #include <string>
+#include <cstdint>
+#include <memory>
 
 #include "basic.h"
+#include "texture.h"
 #include "bitmap_image/bitmap_image.h"
 #include "linalg/linalg.h"
 using namespace linalg::aliases;
 #include "aabb.h"
+#include "bvh.h"
+#include "triangle_store.h"
 
 // Le type d'une "liste de paramètres", e.g. une map de strings vers des listes de nombres.
 typedef std::map<std::string, std::vector<double> > ParamList;
@@ -24,12 +29,11 @@ class Material
 public:
     // Constructeurs
     Material() {};
-    Material(bitmap_image &b, ParamList &params) { init(b, params); }
+    Material(std::shared_ptr<const Texture> texture, ParamList &params) { init(texture, params); }
 
-    void init(bitmap_image &b, ParamList &params)
+    void init(std::shared_ptr<const Texture> texture, ParamList &params)
     {
-#define SET_BITMAP(_name) _name = b;
-        SET_BITMAP(texture_albedo);
+        texture_albedo = texture;
         
 #define SET_VEC3(_name) _name = params[#_name].size() == 3 ? double3{params[#_name][0],params[#_name][1],params[#_name][2]} : double3{0,0,0};
         SET_VEC3(color_albedo);
@@ -46,8 +50,10 @@ public:
         SET_FLOAT(k_reflection)
         SET_FLOAT(k_refraction)
     }
-    // Texture du matériel NON-normalisé [r,g,b \in 0..=255]
-    bitmap_image texture_albedo;
+    // Texture du matériel normalisé [r,g,b \in 0..=1], nullptr si aucune (voir Texture::sample_trilinear()).
+    // Chargée une seule fois par ResourceManager::load_texture() et partagée par tous les matériaux
+    // qui utilisent le même fichier.
+    std::shared_ptr<const Texture> texture_albedo;
 
     // Couleur du matériel normalisé [r,g,b \in 0..=1] si aucune texture n'est présent
     double3 color_albedo;
@@ -73,56 +79,108 @@ public:
     double k_refraction;
 };
 
+// Identifiant d'un matériau: attribué lors de l'analyse de la scène, il remplace le nom du matériau
+// dans les intersections (aucune copie de chaîne ni recherche par nom lors du lancer de rayons).
+typedef uint32_t MaterialId;
+
 // Une classe pour encapsuler l'information suite à l'intersection.
 class Intersection {
 public:
 	// La profondeur du rayon
-	double depth;
+	real depth;
 
 	// La position de l'intersection
-	double3 position;
+	real3 position;
 
 	// La normale à la surface d'intersection
-	double3 normal;
+	real3 normal;
 
 	// Les coordonnées UV associées à l'intersection [entre 0 et 1]
-	double2 uv;
+	real2 uv;
+
+    // L'identifiant du matériel utilisé (voir ResourceManager::material()).
+    MaterialId material_id;
 
-    // La clé associée au matériel utilisé.
-    std::string key_material;
+	Intersection() : depth(REAL_MAX), material_id(0) {}
+};
 
-	Intersection() : depth(DBL_MAX) {}
+// Forme de la transformation d'un objet, déterminée par Object::setup_transform().
+// Les formes simples évitent les produits matrice-vecteur lors de chaque intersection.
+enum class TransformKind {
+    Identity,     // Repère local = repère global.
+    Translation,  // p_global = p_local + translation.
+    UniformScale, // p_global = scale * p_local + translation.
+    Affine        // Cas général: transform, i_transform et n_transform.
 };
 
 // Classe abstraite de base pour les objets.
 class Object
 {
 public:
-    double4x4 transform;   // Transformation de l'espace de l'objet à l'espace global (local --> global).
-    double4x4 i_transform; // Transformation de l'espace de global à l'espace de l'objet (global --> local).
+    real4x4 transform;   // Transformation de l'espace de l'objet à l'espace global (local --> global).
+    real4x4 i_transform; // Transformation de l'espace de global à l'espace de l'objet (global --> local).
     
-    double3x3 n_transform; // Transformation de l'espace de l'objet à l'espace global pour les normales (local --> global).
+    real3x3 n_transform; // Transformation de l'espace de l'objet à l'espace global pour les normales (local --> global).
 
-    std::string key_material; // Matériau de l'objet.
+    TransformKind transform_kind = TransformKind::Affine;
+    real3 translation; // Translation de transform (tous les cas sauf Affine).
+    real scale;        // Facteur d'échelle de transform (UniformScale).
+    real i_scale;      // 1 / scale.
+
+    MaterialId material_id = 0; // Matériau de l'objet (index dans ResourceManager::materials).
 
     // Mets en place les 3 transformations à partir de la transformation (global-vers-objet) donnée.
+    // L'inverse est calculé en double précision, puis converti en real.
     void setup_transform(double4x4 m)
     {
-        transform = m;
-        i_transform = inverse(m);
-        n_transform = {{i_transform[0][0],i_transform[1][0],i_transform[2][0]},
-                       {i_transform[0][1],i_transform[1][1],i_transform[2][1]},
-                       {i_transform[0][2],i_transform[1][2],i_transform[2][2]}};
+        double4x4 i_m = inverse(m);
+        transform = real4x4(m);
+        i_transform = real4x4(i_m);
+        n_transform = real3x3(double3x3{{i_m[0][0],i_m[1][0],i_m[2][0]},
+                                        {i_m[0][1],i_m[1][1],i_m[2][1]},
+                                        {i_m[0][2],i_m[1][2],i_m[2][2]}});
+
+        // Les matrices de la scène sont des produits de Translate, Scale et Rotate: une partie linéaire
+        // exactement diagonale et uniforme n'a subi aucune rotation ni échelle non uniforme.
+        translation = real3(m[3].xyz());
+        scale = real(m[0][0]);
+        i_scale = real(1 / m[0][0]);
+        bool uniform = m[1][1] == scale && m[2][2] == scale && scale != 0
+                    && m[0][1] == 0 && m[0][2] == 0 && m[1][0] == 0 && m[1][2] == 0 && m[2][0] == 0 && m[2][1] == 0
+                    && m[0][3] == 0 && m[1][3] == 0 && m[2][3] == 0 && m[3][3] == 1;
+        if (!uniform) {
+            transform_kind = TransformKind::Affine;
+        } else if (scale != 1) {
+            transform_kind = TransformKind::UniformScale;
+        } else if (translation != real3{0, 0, 0}) {
+            transform_kind = TransformKind::Translation;
+        } else {
+            transform_kind = TransformKind::Identity;
+        }
+    };
+
+    // Rayon ray (repère global) exprimé dans le repère local. La profondeur t est la même dans les deux repères.
+    Ray to_local(const Ray& ray) const {
+        switch (transform_kind) {
+            case TransformKind::Identity:
+                return ray;
+            case TransformKind::Translation:
+                return Ray{ray.origin - translation, ray.direction};
+            case TransformKind::UniformScale:
+                return Ray{(ray.origin - translation) * i_scale, ray.direction * i_scale};
+            default:
+                return Ray{mul(i_transform, {ray.origin,1}).xyz(), mul(i_transform, {ray.direction,0}).xyz()};
+        }
     };
 
     // Intersecte l'objet avec le rayon donné dans le repère global.
     // Retourne true s'il y a eu une intersection avec de l'information sur l'intersection.
     bool intersect(Ray ray, 
-                   double t_min, double t_max, 
+                   real t_min, real t_max, 
                    Intersection* hit) {
 
         //Rayon dans le repère locale
-        Ray lray{mul(i_transform, {ray.origin,1}).xyz(), mul(i_transform, {ray.direction,0}).xyz()};
+        Ray lray = to_local(ray);
         
         //!!! NOTE UTILE : Pour calculer la profondeur dans local_intersect(), si l'intersection se passe à
         //                 ray.origin + ray.direction * t, alors t est la PROFONDEUR
@@ -133,11 +191,27 @@ public:
             //!!! NOTE UTILE : Assurez-vous que la normale est bien normalisée
             //                 et que les coordonnées UV sont contenus [0..1]
 
-            hit->key_material = key_material;
+            hit->material_id = material_id;
 
             // Transforme les coordonnées de l'intersection dans le repère GLOBAL.
-            hit->position = mul(transform,{hit->position,1}).xyz();
-            hit->normal = normalize(mul(n_transform, hit->normal));
+            switch (transform_kind) {
+                case TransformKind::Identity:
+                    hit->normal = normalize(hit->normal);
+                    break;
+                case TransformKind::Translation:
+                    hit->position += translation;
+                    hit->normal = normalize(hit->normal);
+                    break;
+                case TransformKind::UniformScale:
+                    // n_transform = I / scale: seul le signe de scale change la normale normalisée.
+                    hit->position = hit->position * scale + translation;
+                    hit->normal = normalize(scale < 0 ? -hit->normal : hit->normal);
+                    break;
+                default:
+                    hit->position = mul(transform,{hit->position,1}).xyz();
+                    hit->normal = normalize(mul(n_transform, hit->normal));
+                    break;
+            }
             
             return true;
         }
@@ -145,6 +219,15 @@ public:
         return false;
     };
 
+    // Retourne vrai si le rayon (repère global) intersecte l'objet dans l'intervalle ]t_min, t_max[.
+    // Contrairement à intersect, aucune information sur l'intersection n'est calculée (rayons d'ombre).
+    bool occluded(Ray ray, real t_min, real t_max) {
+        return local_occluded(to_local(ray), t_min, t_max);
+    };
+
+    // Les objets sont détruits par le Parser à travers un Object* (Sphere, Mesh, etc.).
+    virtual ~Object() {};
+
     // Construit la boite englobante pour l'objet donnée.
     //
     // !!!NOTE UTILE : Ceci doit être appelé après que les objets soient formées et avant 
@@ -152,17 +235,32 @@ public:
     // !!!NOTE UTILE : Celui-ci doit se faire dans le repère GLOBAL!
     virtual AABB compute_aabb() {
         AABB aabb;
-        aabb.min = double3{-DBL_MAX, -DBL_MAX, -DBL_MAX};
-	    aabb.max = double3{DBL_MAX, DBL_MAX, DBL_MAX};
+        aabb.min = real3{-REAL_MAX, -REAL_MAX, -REAL_MAX};
+	    aabb.max = real3{REAL_MAX, REAL_MAX, REAL_MAX};
 
         return aabb;
     };
+
+    // Transforme un AABB du repère local vers un AABB englobant dans le repère GLOBAL.
+    AABB transform_aabb(AABB local) {
+        std::vector<real3> corners = retrieve_corners(local);
+        for (auto& corner : corners) {
+            corner = mul(transform, {corner, 1}).xyz();
+        }
+        return construct_aabb(corners);
+    };
     
 protected:
     // Intersecte l'objet avec le rayon donné dans le repère local.
     // Cette fonction est spécifique à chaque sous-type d'objet.
     // Retourne true s'il y a eu une intersection, hit est alors mis à jour avec les paramètres.
-    virtual bool local_intersect(Ray ray, double t_min, double t_max, Intersection* hit) = 0;
+    virtual bool local_intersect(Ray ray, real t_min, real t_max, Intersection* hit) = 0;
+
+    // Test d'occlusion dans le repère local. Par défaut, se rabat sur local_intersect.
+    virtual bool local_occluded(Ray ray, real t_min, real t_max) {
+        Intersection hit;
+        return local_intersect(ray, t_min, t_max, &hit) && hit.depth > t_min && hit.depth < t_max;
+    };
 };
 
 
@@ -171,15 +269,20 @@ class Sphere : public Object
 {
 public:
     //Rayon de la sphère
-    double radius;
+    real radius;
 
-    Sphere(double r) : radius(r) {};
+    Sphere(real r) : radius(r) {};
 
     //À adapter pour la sphère.
     virtual AABB compute_aabb();
 protected:
     //À adapter pour la sphère
-    virtual bool local_intersect(Ray ray, double t_min, double t_max, Intersection* hit);
+    virtual bool local_intersect(Ray ray, real t_min, real t_max, Intersection* hit);
+    virtual bool local_occluded(Ray ray, real t_min, real t_max);
+
+private:
+    // Test commun à local_intersect et local_occluded: écrit dans t la racine la plus proche dans ]t_min, t_max[.
+    bool intersect_surface(const Ray& ray, real t_min, real t_max, real* t) const;
 };
 
 
@@ -189,15 +292,21 @@ class Quad : public Object
 {
 public:
     //Demi-Largeur
-    double half_size;
+    real half_size;
 
-    Quad(double s) : half_size(s){};
+    Quad(real s) : half_size(s){};
 
     //À adapter pour le plan
     virtual AABB compute_aabb();
 protected:
     //À adapter pour le plan
-    virtual bool local_intersect(Ray const ray, double t_min, double t_max, Intersection* hit);
+    virtual bool local_intersect(Ray const ray, real t_min, real t_max, Intersection* hit);
+    virtual bool local_occluded(Ray ray, real t_min, real t_max);
+
+private:
+    // Test commun à local_intersect et local_occluded: écrit dans t la profondeur de l'intersection
+    // avec le carré (des deux côtés) si elle est dans ]t_min, t_max[.
+    bool intersect_square(const Ray& ray, real t_min, real t_max, real* t) const;
 };
 
 // Espace Local: Cylindre tel que l'axe principale est aligné à l'axe Y
@@ -206,17 +315,23 @@ class Cylinder : public Object
 {
 public:
     //Rayon du cylindre
-    double radius;
+    real radius;
     //Demi-hauteur du cylindre par rapport à l'origine.
-    double half_height;
+    real half_height;
 
-    Cylinder(double radius, double height) : radius(radius), half_height(height) {};
+    Cylinder(real radius, real height) : radius(radius), half_height(height) {};
 
     //À adapter pour le cylindre
     virtual AABB compute_aabb();
 protected:
     //À adapter pour le cylindre
-    virtual bool local_intersect(Ray ray, double t_min, double t_max, Intersection* hit);
+    virtual bool local_intersect(Ray ray, real t_min, real t_max, Intersection* hit);
+    virtual bool local_occluded(Ray ray, real t_min, real t_max);
+
+private:
+    // Test commun à local_intersect et local_occluded: écrit dans t et normal l'intersection la plus proche
+    // dans ]t_min, t_max[.
+    bool intersect_surface(const Ray& ray, real t_min, real t_max, real* t, real3* normal) const;
 };
 
 // Une classe pour représenter le sommet d'un polygone. 
@@ -258,13 +373,20 @@ public:
 class Mesh : public Object {
 public:
     // Contenant pour les positions, coordonnées de texture, normales et couleurs. Recherche par indice.
-    std::vector<double3> positions;
-    std::vector<double3> normals;
-    std::vector<double2> tex_coords;
+    std::vector<real3> positions;
+    std::vector<real3> normals;
+    std::vector<real2> tex_coords;
 
     // Les triangles sont des triplets de sommets.
+    // Après la construction de bvh, ils sont ordonnés par feuille: la feuille couvre triangles[offset, offset + n_objects).
     std::vector<Triangle> triangles;
 
+    // Arbre BVH sur les triangles, dans le repère local.
+    BVHTree bvh;
+
+    // Triangles prétraités pour Möller–Trumbore, dans le même ordre que triangles.
+    TriangleStore store;
+
     // Lis les données OBJ d'un fichier donné.
     Mesh(std::ifstream& file)
     {
@@ -291,10 +413,10 @@ public:
             } // Données de sommet.
             else if (opCode[0] == 'v') {
 
-                // Lis jusqu'à 4 doubles.
-                std::vector<double> vec;
+                // Lis jusqu'à 4 nombres.
+                std::vector<real> vec;
                 for (int i = 0; opStream.good() && i < 3; i++) {
-                    double v;
+                    real v;
                     opStream >> v;
                     vec.push_back(v);
                 }
@@ -377,17 +499,23 @@ public:
         }
     }
 
+    // Construit bvh sur les triangles (SAH) avec num_threads fils, réordonne triangles selon les feuilles
+    // de l'arbre et remplit store. Doit être appelé une fois, avant le premier lancer de rayon.
+    void build_bvh(int num_threads);
+
     //À adapter pour le mesh
     virtual AABB compute_aabb();
 protected:
     //À adapter pour le mesh
-    virtual bool local_intersect(Ray const ray, double t_min, double t_max, Intersection* hit);
+    virtual bool local_intersect(Ray const ray, real t_min, real t_max, Intersection* hit);
+    virtual bool local_occluded(Ray ray, real t_min, real t_max);
 
     // Trouve le point d'intersection entre le rayon donné et le maillage triangulaire.
     // Renvoie true ssi une intersection existe, et remplit les données de
     // la structure hit avec les bonnes informations.
+    // Test géométrique d'origine; local_intersect utilise store. Conservé comme référence (bench/triangle_bench.cpp).
     bool intersect_triangle(Ray const ray,
-                            double t_min, double t_max,
+                            real t_min, real t_max,
                             Triangle const tri,
                             Intersection *hit);
 };
@@ -1,4 +1,5 @@
 #include "parser.h"
+#include "scheduler.h"
 
 #define LEX_ERROR(error) { \
     std::stringstream ss; \
@@ -229,17 +230,6 @@ std::string Lexer::get_string() {
     return token.string;
 }
 
-bitmap_image Lexer::get_bitmap() {
-    std::string t;
-    bitmap_image m;
-    t = get_string();
-    if(t.length() == 0){
-        return bitmap_image();
-    }
-    m = bitmap_image(t);
-    return m;
-}
-
 ParamList Lexer::get_param_list(unsigned int min, unsigned int max) {
     ParamList map;
     while (true) {
@@ -266,11 +256,23 @@ bool Parser::parse() {
         Token token = lexer.peek();
         switch (token.type) {
             case END_OF_FILE:
+                // Les BVH des maillages sont construits avec le nombre de fils de la scène.
+                for (Mesh* mesh : pending_meshes) {
+                    mesh->build_bvh(resolve_thread_count(scene.num_threads));
+                    mesh->bvh.stats.print(std::cout, "Mesh BVH_SAH", int(mesh->triangles.size()), "triangles");
+                }
+                pending_meshes.clear();
+
                 if (container == "BVH") {
-                    scene.container = new BVH(objects);
+                    scene.container = new BVH(objects, BVHBuildMode::Median, BVHCostModel(), resolve_thread_count(scene.num_threads));
+                } else if (container == "BVH_SAH") {
+                    scene.container = new BVH(objects, BVHBuildMode::SAH, bvh_cost_model, resolve_thread_count(scene.num_threads));
+                } else if (container == "BVH4") {
+                    scene.container = new BVH4(objects, bvh_cost_model, resolve_thread_count(scene.num_threads));
                 } else if (container == "Naive") {
                     scene.container = new Naive(objects);
                 }
+                ResourceManager::Instance()->print_memory(std::cout);
 
                 return true;
             case ERROR:
@@ -296,6 +298,10 @@ bool Parser::parse() {
             HANDLE_NAME(ambient_light)
             HANDLE_NAME(max_ray_depth)
             HANDLE_NAME(jitter_radius)
+            HANDLE_NAME(tile_size)
+            HANDLE_NAME(threads)
+            HANDLE_NAME(seed)
+            HANDLE_NAME(bvh_cost)
 
 
             HANDLE_NAME(Perspective)
@@ -319,7 +325,7 @@ bool Parser::parse() {
             if(name == "container") {
                 container = lexer.get_string();
 
-                if (!(container == "BVH" || container == "Naive")) {
+                if (!(container == "BVH" || container == "BVH_SAH" || container == "BVH4" || container == "Naive")) {
                     std::cerr << "parsing failed due to unknown container \"" << container << "\"" << std::endl;
                     return false;
                 }
@@ -361,6 +367,34 @@ void Parser::parse_max_ray_depth() {
     scene.max_ray_depth = static_cast<int>(lexer.get_number());
 }
 
+void Parser::parse_tile_size() {
+    scene.tile_size = static_cast<int>(lexer.get_number());
+    if (scene.tile_size < 1) {
+        throw std::string("tile_size must be at least 1");
+    }
+}
+
+void Parser::parse_threads() {
+    scene.num_threads = static_cast<int>(lexer.get_number());
+}
+
+void Parser::parse_seed() {
+    scene.seed = static_cast<int>(lexer.get_number());
+}
+
+void Parser::parse_bvh_cost() {
+    ParamList params = lexer.get_param_list(1, 1);
+
+    if (params.count("traversal_cost")) bvh_cost_model.traversal_cost = params["traversal_cost"][0];
+    if (params.count("intersection_cost")) bvh_cost_model.intersection_cost = params["intersection_cost"][0];
+    if (params.count("bins")) bvh_cost_model.n_bins = static_cast<int>(params["bins"][0]);
+    if (params.count("max_leaf_size")) bvh_cost_model.max_leaf_size = static_cast<int>(params["max_leaf_size"][0]);
+
+    if (bvh_cost_model.n_bins < 2 || bvh_cost_model.max_leaf_size < 1) {
+        throw std::string("bvh_cost requires bins >= 2 and max_leaf_size >= 1");
+    }
+}
+
 void Parser::parse_Perspective() {
     scene.camera.fovy = lexer.get_number();
     scene.camera.aspect = lexer.get_number();
@@ -384,9 +418,9 @@ void Parser::parse_LookAt() {
 void Parser::parse_Material() {
     std::string name = lexer.get_string();
     lexer.get_string();
-    bitmap_image m = lexer.get_bitmap();
+    std::shared_ptr<const Texture> texture = ResourceManager::Instance()->load_texture(lexer.get_string());
     ParamList params = lexer.get_param_list(1, 4);
-    ResourceManager::Instance()->materials[name] = Material(m,params);
+    ResourceManager::Instance()->add_material(name, Material(texture,params));
 
 }
 
@@ -478,6 +512,7 @@ void Parser::parse_Mesh() {
         std::cout << obj->triangles.size() << " triangles" << std::endl;
 
         finish_object(obj);
+        pending_meshes.push_back(obj);
     } catch (std::string e) {
         // OK.
         std::cout << "Could not be parse :: " << e << std::endl;
@@ -491,12 +526,13 @@ void Parser::finish_object(Object *obj) {
 
     // Get the material name, and make sure that material exists.
     std::string material_name = lexer.get_string();
-    if (!ResourceManager::Instance()->materials.count(material_name)) {
+    MaterialId material_id;
+    if (!ResourceManager::Instance()->find_material(material_name, &material_id)) {
         std::stringstream ss;
         ss << "no material \"" << material_name << "\"" << std::endl;
         throw(ss.str());
     }
-    obj->key_material = material_name;
+    obj->material_id = material_id;
 
     // Set transform, inv transform, and normal transform.
     obj->setup_transform(transform_stack.back());
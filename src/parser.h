@@ -95,7 +95,6 @@ public:
     // Min/max s'appliquent à chaque liste, tout comme get_numbers().
     ParamList get_param_list(unsigned int min = 0,
                            unsigned int max = UINT_MAX);
-    bitmap_image get_bitmap();
 private:
     // Le flux d'entrée.
     std::istream *_input;
@@ -117,6 +116,11 @@ private:
 
     std::vector<Object*> objects;
 
+    // Maillages dont le BVH reste à construire: la commande threads peut suivre le maillage dans le fichier.
+    std::vector<Mesh*> pending_meshes;
+
+    BVHCostModel bvh_cost_model; // Paramètres de la construction "BVH_SAH".
+
     // Les fonctions suivantes analysent toutes les commandes qui peuvent être
     // trouvées dans un fichier .ray.
 
@@ -126,6 +130,10 @@ private:
     void parse_jitter_radius();
     void parse_ambient_light();
     void parse_max_ray_depth();
+    void parse_tile_size();
+    void parse_threads();
+    void parse_seed();
+    void parse_bvh_cost();
 
     //Argument pour la caméra
     void parse_Perspective();
@@ -159,7 +167,7 @@ public:
     Parser(std::istream *input) : lexer(input) {}
 
     ~Parser() {
-        if(!scene.container){
+        if(scene.container){
             delete scene.container;
         }
 
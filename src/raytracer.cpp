@@ -1,4 +1,6 @@
 #include "raytracer.h"
+#include "scheduler.h"
+#include "camera.h"
 
 void Raytracer::render(const Scene& scene, Frame* output)
 {       
@@ -10,86 +12,95 @@ void Raytracer::render(const Scene& scene, Frame* output)
 
 	// @@@@@@ VOTRE CODE ICI
 	// Calculez les paramètres de la caméra pour les rayons.
-	
-	// Base vectors for basis change
-	double3 forward = normalize(scene.camera.center - scene.camera.position);
-	double3 right = normalize(cross(scene.camera.up, forward));
-	double3 up = normalize(cross(right, forward)); // guarantees 90 degree angle for up
-	double3 pos = scene.camera.position;
-
-	// Viewport paramters
-	double FOVy_rads = deg2rad(scene.camera.fovy);
-	double vp_height = tan(FOVy_rads/2)*2; // Assumes distance between camera origin and viewport center is normalized
-	double vp_width = vp_height * scene.camera.aspect; // Assuming aspect ratio is width:height
-	double3 top_left_corner = scene.camera.center + scene.camera.up*(vp_height/2) 
-		+ cross(scene.camera.center, scene.camera.up)*(vp_width/2); // Left vector is cross product between up and center vectors
-
-
-    // Itère sur tous les pixels de l'image.
-    for(int y = 0; y < scene.resolution[1]; y++) {
-		if (y % 40){
-			std::cout << "\rScanlines completed: " << y << "/" << scene.resolution[1] << '\r';
+	// La base et le changement de repère sont calculés une seule fois pour toute l'image.
+	CameraRayGenerator camera(scene);
+
+	// Découpe l'image en tuiles qui sont réparties entre les fils.
+	// Chaque pixel appartient à une seule tuile: les écritures dans output et z_buffer ne se chevauchent pas.
+	std::vector<Tile> tiles = split_into_tiles(scene.resolution[0], scene.resolution[1], scene.tile_size);
+
+	TileReport report = parallel_for_tiles(tiles, resolve_thread_count(scene.num_threads), [&](const Tile& tile, int) {
+		// Générateur propre au fil; repositionné pour chaque pixel et échantillon.
+		Sampler sampler(scene.seed);
+
+		int n_samples = int(std::ceil(scene.samples_per_pixel));
+		int n_pixels = (tile.x_end - tile.x_begin) * (tile.y_end - tile.y_begin);
+
+		// Décalages de jitter de tous les échantillons d'un pixel, tirés 8 à la fois.
+		std::vector<double2> pixel_jitters(n_samples);
+
+		// Décalages et rayons primaires de toute la tuile, rangés par échantillon:
+		// l'échantillon iray du pixel ipixel (pixels de la tuile ligne par ligne) est à iray * n_pixels + ipixel.
+		std::vector<double2> jitters(size_t(n_samples) * n_pixels);
+		std::vector<Ray> rays(jitters.size());
+
+		int ipixel = 0;
+		for(int y = tile.y_begin; y < tile.y_end; y++) {
+			for(int x = tile.x_begin; x < tile.x_end; x++, ipixel++) {
+				sampler.start_pixel(x + y*scene.resolution[0]);
+				sampler.fill_double2(pixel_jitters.data(), n_samples);
+				for(int iray = 0; iray < n_samples; iray++) {
+					jitters[size_t(iray) * n_pixels + ipixel] = pixel_jitters[iray];
+				}
+			}
 		}
 
-        for(int x = 0; x < scene.resolution[0]; x++) {
+		// Lancez le rayon de manière uniformément aléatoire à l'intérieur du pixel dans la zone délimité par jitter_radius.
+		// Un lot de rayons par échantillon, pour toute la tuile.
+		for(int iray = 0; iray < n_samples; iray++) {
+			camera.generate_tile(tile, &jitters[size_t(iray) * n_pixels], &rays[size_t(iray) * n_pixels]);
+		}
 
-			int avg_z_depth = 0;
-			double3 avg_ray_color{0,0,0};
+		// Itère sur tous les pixels de la tuile.
+		ipixel = 0;
+		for(int y = tile.y_begin; y < tile.y_end; y++) {
+			for(int x = tile.x_begin; x < tile.x_end; x++, ipixel++) {
+				double avg_z_depth = 0;
+				double3 avg_ray_color{0,0,0};
 			
-			for(int iray = 0; iray < scene.samples_per_pixel; iray++) {
-				// Génère le rayon approprié pour ce pixel.
-				Ray ray;
-				// Initialise la profondeur de récursivité du rayon.
-				int ray_depth = 0;
-				// Initialize la couleur du rayon
-				double3 ray_color{0,0,0};
-
-				// @@@@@@ VOTRE CODE ICI
-				// Mettez en place le rayon primaire en utilisant les paramètres de la caméra.
-				ray.origin = scene.camera.position;
-
-				// Lancez le rayon de manière uniformément aléatoire à l'intérieur du pixel dans la zone délimité par jitter_radius.
-				double3 pixel_pos{-scene.resolution[0]/2 + x + 0.5, scene.resolution[1]/2 - y - 0.5, length(scene.camera.center-scene.camera.position)}; // Pixel center position
-				pixel_pos += double3{-scene.jitter_radius + rand_double()*scene.jitter_radius*2, -scene.jitter_radius + rand_double()*scene.jitter_radius*2, 0}; // Apply jitter to pixel
-				pixel_pos = {pixel_pos[0]/scene.resolution[0]*vp_width, pixel_pos[1]/scene.resolution[1]*vp_height, pixel_pos[2]}; // Stretch to plane
-
-				// Basis change
-				double4x4 cam_to_world_matrix{
-					{right[0],up[0],forward[0],pos[0]},
-					{right[1],up[1],forward[1],pos[1]},
-					{right[2],up[2],forward[2],pos[2]},
-					{0,0,0,1}};
-				double4x4 world_to_cam_matrix = inverse(cam_to_world_matrix);				
-				double4 tmp = mul(world_to_cam_matrix, {pixel_pos[0],pixel_pos[1],pixel_pos[2],1});
-				pixel_pos = {tmp[0],tmp[1],tmp[2]};
-
-				
-				ray.direction = normalize(pixel_pos-ray.origin); // Set ray direction (normalized)
-
-				// Initiliaze ray depth
-				double z_depth = scene.camera.z_far;
-
-				// Faites la moyenne des différentes couleurs obtenues suite à la récursion.
-				trace(scene, ray, ray_depth, &ray_color, &z_depth); // Recursion
-				avg_ray_color += ray_color;
-				avg_z_depth += z_depth;
+				for(int iray = 0; iray < scene.samples_per_pixel; iray++) {
+					sampler.start_sample(x + y*scene.resolution[0], iray);
+
+					// Génère le rayon approprié pour ce pixel.
+					Ray ray = rays[size_t(iray) * n_pixels + ipixel];
+					// Initialise la profondeur de récursivité du rayon.
+					int ray_depth = 0;
+					// Initialize la couleur du rayon
+					double3 ray_color{0,0,0};
+
+					// Initiliaze ray depth
+					double z_depth = scene.camera.z_far;
+
+					// Faites la moyenne des différentes couleurs obtenues suite à la récursion.
+					trace(scene, ray, ray_depth, sampler, &ray_color, &z_depth); // Recursion
+					avg_ray_color += ray_color;
+					avg_z_depth += z_depth;
+				}
+
+				avg_z_depth = avg_z_depth / scene.samples_per_pixel;
+				avg_ray_color = avg_ray_color / scene.samples_per_pixel;
+
+				// Test de profondeur
+				if(avg_z_depth >= scene.camera.z_near && avg_z_depth <= scene.camera.z_far && 
+					avg_z_depth < z_buffer[x + y*scene.resolution[0]]) {
+					z_buffer[x + y*scene.resolution[0]] = avg_z_depth;
+
+					// Met à jour la couleur de l'image (et sa profondeur)
+					output->set_color_pixel(x, y, avg_ray_color);
+					output->set_depth_pixel(x, y, (avg_z_depth - scene.camera.z_near) / 
+											(scene.camera.z_far-scene.camera.z_near));
+				}
+				else {
+					// Aucune intersection entre z_near et z_far: profondeur normalisée de z_far, et non 0
+					// qui correspondrait à une intersection à z_near.
+					output->set_depth_pixel(x, y, 1.0);
+				}
 			}
+		}
+	});
 
-			avg_z_depth = avg_z_depth / scene.samples_per_pixel;
-			avg_ray_color = avg_ray_color / scene.samples_per_pixel;
-
-			// Test de profondeur
-			if(avg_z_depth >= scene.camera.z_near && avg_z_depth <= scene.camera.z_far && 
-				avg_z_depth < z_buffer[x + y*scene.resolution[0]]) {
-				z_buffer[x + y*scene.resolution[0]] = avg_z_depth;
-
-				// Met à jour la couleur de l'image (et sa profondeur)
-				output->set_color_pixel(x, y, avg_ray_color);
-				output->set_depth_pixel(x, y, (avg_z_depth - scene.camera.z_near) / 
-										(scene.camera.z_far-scene.camera.z_near));
-			}
-        }
-    }
+	// Coût par tuile afin de repérer les régions coûteuses de l'image.
+	report.print(std::cout, tiles);
 
     delete[] z_buffer;
 }
@@ -105,13 +116,13 @@ void Raytracer::render(const Scene& scene, Frame* output)
 //            pour la couleur de sortie.
 //          - Mettre à jour la nouvelle profondeure.
 void Raytracer::trace(const Scene& scene,
-					  Ray ray, int ray_depth,
+					  Ray ray, int ray_depth, Sampler& sampler,
 					  double3* out_color, double* out_z_depth)
 {
 	Intersection hit;
 	// Fait appel à l'un des containers spécifiées.
-	if(scene.container->intersect(ray,EPSILON,*out_z_depth,&hit)) {		
-		Material& material = ResourceManager::Instance()->materials[hit.key_material];
+	if(scene.container->intersect(ray,ray_epsilon(ray.origin),*out_z_depth,&hit)) {		
+		Material& material = ResourceManager::Instance()->material(hit.material_id);
 
 		// @@@@@@ VOTRE CODE ICI
 		// Déterminer la couleur associée à la réflection d'un rayon de manière récursive.
@@ -123,7 +134,7 @@ void Raytracer::trace(const Scene& scene,
 		//
 		// Toutes les géométries sont des surfaces et non pas de volumes.
 
-		*out_color = shade(scene,hit);
+		*out_color = shade(scene,hit,sampler);
 		*out_z_depth = hit.depth;
 	}
 }
@@ -136,16 +147,30 @@ void Raytracer::trace(const Scene& scene,
 //	          	- Inclure la contribution diffuse. (Faites attention au produit scalare. >= 0)
 //   	  	- Inclure la contribution ambiante
 //      * Calculer si le point est dans l'ombre
-//			- Itérer sur tous les objets et détecter si le rayon entre l'intersection et la lumière est occludé.
+//			- Itérer sur tous les objets et détecter si le rayon entre l'intersection et la lumière est occludé (voir visible()).
 //				- Ne pas considérer les points plus loins que la lumière.
 //			- Par la suite, intégrer la pénombre dans votre calcul
 //		* Déterminer la couleur du point d'intersection.
-//        	- Si texture est présente, prende la couleur à la coordonnées uv
+//        	- Si texture est présente, prende la couleur à la coordonnées uv (voir Texture::sample_trilinear())
 //			- Si aucune texture, prendre la couleur associé au matériel.
 
-double3 Raytracer::shade(const Scene& scene, Intersection hit)
+double3 Raytracer::shade(const Scene& scene, Intersection hit, Sampler& /*sampler*/)
 {
-	// Material& material = ResourceManager::Instance()->materials[hit.key_material]; lorsque vous serez rendu à la partie texture.
+	// Material& material = ResourceManager::Instance()->material(hit.material_id); lorsque vous serez rendu à la partie texture.
 	
 	return double3{0,0,0};
 }
+
+bool Raytracer::visible(const Scene& scene, double3 from, double3 to)
+{
+	double3 direction = to - from;
+	double distance = length(direction);
+	double t_min = ray_epsilon(real3(from));
+	double t_max = distance - ray_epsilon(real3(to));
+	if (t_max <= t_min) {
+		return true;
+	}
+
+	Ray shadow_ray(real3(from), real3(direction / distance));
+	return !scene.container->occluded(shadow_ray, real(t_min), real(t_max));
+}
@@ -12,6 +12,7 @@
 #include "scene.h"
 #include "frame.h"
 #include "resource_manager.h"
+#include "sampler.h"
 #include "linalg/linalg.h"
 using namespace linalg::aliases;
 
@@ -30,11 +31,12 @@ private:
     //   scene: Scène dans laquelle le rayon est lancé
     //   rayon: Rayon actuel dans la scène
     //   ray_depth: Profondeur de récursion du rayon actuellement lancé
+    //   sampler: Générateur aléatoire du fil courant
     //   out_color: Couleur associée à l'intersection
     //   out_z_depth: Profondeur de la plus proche intersection qui agit comme une borne supérieure
 
     static void trace(const Scene& scene, 
-                      Ray ray, int ray_depth, 
+                      Ray ray, int ray_depth, Sampler& sampler,
                       double3 *out_color, double *out_z_depth);
 
     // Calcule l'ombrage (le shading) à l'intersection avec la géométrie.
@@ -43,8 +45,14 @@ private:
     // Paramètres
     //   scene: Scène dans laquelle le rayon est lancé
     //   hit: Information sur l'intersection
+    //   sampler: Générateur aléatoire du fil courant (pénombre des lumières sphériques)
     //
     // Renvoie la couleur calculée au point d'intersection.
 	static double3 shade(const Scene& scene,
-                        Intersection hit);
+                        Intersection hit, Sampler& sampler);
+
+    // Vrai si aucun objet ne se trouve sur le segment entre from et to (e.g. un point d'intersection
+    // et un point échantillonné sur une lumière). Les extrémités sont exclues à ray_epsilon près (basic.h).
+    // Utilise IContainer::occluded: le parcours s'arrête au premier objet trouvé.
+    static bool visible(const Scene& scene, double3 from, double3 to);
 };
\ No newline at end of file
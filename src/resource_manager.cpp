@@ -6,8 +6,61 @@ ResourceManager::ResourceManager(){};
 
 ResourceManager::~ResourceManager() {
   materials.clear();
+  material_ids.clear();
+  textures.clear();
 };
 
+MaterialId ResourceManager::add_material(const std::string& name, const Material& material) {
+  auto it = material_ids.find(name);
+  if (it != material_ids.end()) {
+    materials[it->second] = material;
+    return it->second;
+  }
+
+  MaterialId id = MaterialId(materials.size());
+  materials.push_back(material);
+  material_ids[name] = id;
+  return id;
+}
+
+std::shared_ptr<const Texture> ResourceManager::load_texture(const std::string& path) {
+  if (path.empty()) {
+    return nullptr;
+  }
+
+  auto it = textures.find(path);
+  if (it != textures.end()) {
+    return it->second;
+  }
+
+  std::shared_ptr<const Texture> texture = std::make_shared<const Texture>(bitmap_image(path));
+  textures[path] = texture;
+  return texture;
+}
+
+void ResourceManager::print_memory(std::ostream& out) const {
+  size_t total_bytes = 0;
+  for (const auto& entry : textures) {
+    const Texture& texture = *entry.second;
+    size_t bytes = texture.memory_bytes();
+    total_bytes += bytes;
+    // La cache garde elle-même une référence.
+    out << "Texture \"" << entry.first << "\": " << texture.width() << "x" << texture.height() << ", "
+        << texture.n_levels() << " levels, " << bytes / 1024.0 << " KB, used by " << entry.second.use_count() - 1 << " materials" << std::endl;
+  }
+  out << "Resources: " << materials.size() << " materials, " << textures.size() << " textures, "
+      << total_bytes / (1024.0 * 1024.0) << " MB of texture memory" << std::endl;
+}
+
+bool ResourceManager::find_material(const std::string& name, MaterialId* id) const {
+  auto it = material_ids.find(name);
+  if (it == material_ids.end()) {
+    return false;
+  }
+  *id = it->second;
+  return true;
+}
+
 ResourceManager* ResourceManager::Instance() {
   if (Instance_ == NULL) {
     Instance_ = new ResourceManager();
@@ -10,8 +10,32 @@ class ResourceManager {
   // Relâche l'instance
   static void Release();
 
-  // Tous les différents matériaux sont conversés ici question de performance
-  std::map<std::string, Material> materials;
+  // Tous les différents matériaux sont conversés ici question de performance.
+  // Un matériau est désigné par son identifiant, son index dans materials.
+  std::vector<Material> materials;
+
+  // Identifiant de chaque matériau selon son nom (utilisé seulement lors de l'analyse de la scène).
+  std::map<std::string, MaterialId> material_ids;
+
+  // Ajoute le matériau name et retourne son identifiant.
+  // Si name existe déjà, le matériau est remplacé et garde le même identifiant.
+  MaterialId add_material(const std::string& name, const Material& material);
+
+  // Retourne vrai et écrit l'identifiant du matériau name dans id s'il existe.
+  bool find_material(const std::string& name, MaterialId* id) const;
+
+  // Matériau associé à l'identifiant id.
+  Material& material(MaterialId id) { return materials[id]; }
+
+  // Textures chargées selon leur chemin. Chaque image n'est lue et convertie qu'une fois et est partagée
+  // (en lecture seule) par les matériaux qui la référencent.
+  std::map<std::string, std::shared_ptr<const Texture>> textures;
+
+  // Retourne la texture du fichier path, chargée lors du premier appel. Retourne nullptr si path est vide.
+  std::shared_ptr<const Texture> load_texture(const std::string& path);
+
+  // Affiche le nombre de matériaux et, pour chaque texture, sa taille en mémoire et le nombre de matériaux qui l'utilisent.
+  void print_memory(std::ostream& out) const;
 private:
   static ResourceManager* Instance_;
  
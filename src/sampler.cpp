@@ -0,0 +1,71 @@
+#include "sampler.h"
+#include "cpu.h"
+
+#include <algorithm>
+
+// Nombre maximal de blocs tirés à chaque appel du noyau.
+#define SAMPLER_MAX_BLOCKS 16
+
+namespace {
+
+// Repli scalaire: même récurrence que pcg32_8, un flux à la fois.
+void pcg32_8_next_double_scalar(uint64_t state[SAMPLER_LANES], const uint64_t inc[SAMPLER_LANES], double* out, int n_blocks) {
+	for (int lane = 0; lane < SAMPLER_LANES; lane++) {
+		pcg32 rng;
+		rng.state = state[lane];
+		rng.inc = inc[lane];
+		for (int b = 0; b < n_blocks; b++) {
+			out[SAMPLER_LANES * b + lane] = rng.nextDouble();
+		}
+		state[lane] = rng.state;
+	}
+}
+
+typedef void (*NextDoubleBlocks)(uint64_t*, const uint64_t*, double*, int);
+
+NextDoubleBlocks select_kernel() {
+#if defined(RAY_HAS_AVX2_KERNELS)
+	if (cpu_has_avx2()) {
+		return pcg32_8_next_double_avx2;
+	}
+#endif
+	return pcg32_8_next_double_scalar;
+}
+
+}
+
+void Sampler::start_pixel(uint64_t ipixel) {
+	// Les flux vectoriels partagent le flux PCG du pixel, mais avec des états initiaux
+	// distincts de ceux utilisés par start_sample().
+	const uint64_t lane_salt = 0x6a09e667f3bcc909ULL;
+
+	for (int lane = 0; lane < SAMPLER_LANES; lane++) {
+		pcg32 lane_rng(mix(seed ^ mix(lane ^ lane_salt)), ipixel);
+		lane_state[lane] = lane_rng.state;
+		lane_inc[lane] = lane_rng.inc;
+	}
+}
+
+void Sampler::next_double_blocks(double* out, int n_blocks) {
+	static const NextDoubleBlocks kernel = select_kernel();
+	kernel(lane_state, lane_inc, out, n_blocks);
+}
+
+void Sampler::fill_double2(double2* out, int count) {
+	// Paires de blocs: le premier donne u, le second v, pour SAMPLER_LANES valeurs.
+	alignas(32) double uv[SAMPLER_LANES * SAMPLER_MAX_BLOCKS];
+
+	int filled = 0;
+	while (filled < count) {
+		int n_pairs = std::min((count - filled + SAMPLER_LANES - 1) / SAMPLER_LANES, SAMPLER_MAX_BLOCKS / 2);
+		next_double_blocks(uv, 2 * n_pairs);
+
+		for (int pair = 0; pair < n_pairs; pair++) {
+			const double* u = &uv[SAMPLER_LANES * (2 * pair)];
+			const double* v = &uv[SAMPLER_LANES * (2 * pair + 1)];
+			for (int lane = 0; lane < SAMPLER_LANES && filled < count; lane++) {
+				out[filled++] = double2{u[lane], v[lane]};
+			}
+		}
+	}
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+
+#include "basic.h"
+#include "pcg32/pcg32.h"
+#include "linalg/linalg.h"
+using namespace linalg::aliases;
+
+// Générateur de nombres aléatoires utilisé durant le rendu.
+//
+// Chaque fil possède son propre Sampler: il n'y a aucun état partagé entre les fils.
+// La séquence est repositionnée au début de chaque échantillon à partir de la graine de la scène,
+// de l'indice du pixel et de l'indice de l'échantillon. Une même graine produit donc la même
+// image peu importe le nombre de fils ou l'ordre dans lequel les tuiles sont rendues.
+class Sampler
+{
+public:
+    Sampler(uint64_t seed) : seed(seed) {}
+
+    // Positionne la séquence sur l'échantillon isample du pixel ipixel.
+    void start_sample(uint64_t ipixel, uint64_t isample) {
+        // Chaque pixel utilise son propre flux PCG; l'état initial dépend de la graine et de l'échantillon.
+        rng.seed(mix(seed ^ mix(isample)), ipixel);
+    }
+
+    // Valeur aléatoire entre [0,1)
+    double next_double() {
+        return rng.nextDouble();
+    }
+
+    // Valeur aléatoire entre [0,1) pour un vecteur
+    double2 next_double2() {
+        double u = next_double();
+        double v = next_double();
+        return double2{u, v};
+    }
+
+    // Valeur aléatoire à l'intérieur d'un disque.
+    double2 next_in_unit_disk() {
+        while (true) {
+            auto p = (2.0 * next_double2() - 1.0);
+            if (length2(p) >= 1) continue;
+            return p;
+        }
+    }
+
+    // Positionne les SAMPLER_LANES flux du générateur vectoriel sur le pixel ipixel.
+    // fill_double2 tire alors ses valeurs 8 à la fois avec pcg32_8 (AVX2),
+    // ou avec 8 pcg32 scalaires si le processeur ne supporte pas AVX2. Les deux chemins
+    // produisent exactement les mêmes valeurs.
+    void start_pixel(uint64_t ipixel);
+
+    // Remplit out[0..count) de valeurs entre [0,1)^2, e.g. les décalages de jitter de chaque échantillon.
+    void fill_double2(double2* out, int count);
+
+private:
+    // Mélange de bits (SplitMix64) afin que des indices consécutifs donnent des états décorrélés.
+    static uint64_t mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // Tire n_blocks blocs de SAMPLER_LANES valeurs entre [0,1); out[SAMPLER_LANES * b + lane] provient du flux lane.
+    // out doit être aligné sur 32 octets.
+    void next_double_blocks(double* out, int n_blocks);
+
+    uint64_t seed;
+    pcg32 rng;
+
+    // État des flux du générateur vectoriel, dans la disposition mémoire de pcg32_8.
+    alignas(32) uint64_t lane_state[SAMPLER_LANES];
+    alignas(32) uint64_t lane_inc[SAMPLER_LANES];
+};
+
+// Noyau AVX2 (sampler_avx2.cpp): avance les 8 flux de n_blocks pas avec pcg32_8 et écrit les valeurs entre [0,1).
+void pcg32_8_next_double_avx2(uint64_t state[SAMPLER_LANES], const uint64_t inc[SAMPLER_LANES], double* out, int n_blocks);
@@ -0,0 +1,24 @@
+// Compilé avec AVX2 (voir CMakeLists.txt). N'est appelé que si cpu_has_avx2() est vrai.
+//
+// Ce fichier n'inclut que pcg32_8.h et constants.h (sans fonction): aucune fonction inline
+// partagée avec le reste du programme n'y est compilée avec AVX2.
+
+#include <cstdint>
+#include <cstring>
+
+#include "constants.h"
+#include "pcg32/pcg32_8.h"
+
+void pcg32_8_next_double_avx2(uint64_t state[SAMPLER_LANES], const uint64_t inc[SAMPLER_LANES], double* out, int n_blocks) {
+	pcg32_8 rng(state, inc);
+
+	// On remplace l'état amorcé par l'état courant des flux (state[0] = flux 0..3, state[1] = flux 4..7).
+	std::memcpy(rng.state, state, sizeof(rng.state));
+	std::memcpy(rng.inc, inc, sizeof(rng.inc));
+
+	for (int b = 0; b < n_blocks; b++) {
+		rng.nextDouble(&out[SAMPLER_LANES * b]);
+	}
+
+	std::memcpy(state, rng.state, sizeof(rng.state));
+}
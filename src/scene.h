@@ -79,6 +79,15 @@ public:
     //Le nombre maximal de récursion possible.
     int max_ray_depth;
 
+    // Taille (en pixels) des tuiles réparties entre les fils lors du rendu.
+    int tile_size;
+
+    // Nombre de fils utilisés pour le rendu [0 -> nombre de coeurs de la machine].
+    int num_threads;
+
+    // Graine des séquences aléatoires. Une même graine produit la même image peu importe le nombre de fils.
+    int seed;
+
     // La caméra utilisée durant le rendu de la scène.
     Camera camera;
 
@@ -98,5 +107,9 @@ public:
         resolution[0] = resolution[1] = 640;
         samples_per_pixel = 1;
         max_ray_depth = 0;
+        tile_size = 32;
+        num_threads = 0;
+        seed = 0;
+        container = nullptr;
     }
 };
\ No newline at end of file
@@ -0,0 +1,193 @@
+#include "scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <numeric>
+#include <thread>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+double elapsed_ms(Clock::time_point start, Clock::time_point end) {
+	return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+// File de tuiles propre à un fil.
+// Le propriétaire retire par l'avant, les autres fils volent par l'arrière.
+class TileDeque {
+public:
+	void push_back(int itile) {
+		std::lock_guard<std::mutex> lock(mutex);
+		tiles.push_back(itile);
+	}
+
+	bool pop_front(int& itile) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (tiles.empty()) {
+			return false;
+		}
+		itile = tiles.front();
+		tiles.pop_front();
+		return true;
+	}
+
+	bool steal_back(int& itile) {
+		std::lock_guard<std::mutex> lock(mutex);
+		if (tiles.empty()) {
+			return false;
+		}
+		itile = tiles.back();
+		tiles.pop_back();
+		return true;
+	}
+
+private:
+	std::deque<int> tiles;
+	std::mutex mutex;
+};
+
+}
+
+std::vector<Tile> split_into_tiles(int width, int height, int tile_size) {
+	std::vector<Tile> tiles;
+	tile_size = std::max(tile_size, 1);
+
+	for (int y = 0; y < height; y += tile_size) {
+		for (int x = 0; x < width; x += tile_size) {
+			tiles.push_back(Tile{x, y, std::min(x + tile_size, width), std::min(y + tile_size, height)});
+		}
+	}
+
+	return tiles;
+}
+
+int resolve_thread_count(int requested) {
+	if (requested > 0) {
+		return requested;
+	}
+
+	// hardware_concurrency() peut retourner 0 si l'information n'est pas disponible.
+	return std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+void parallel_for(int n, int num_threads, const std::function<void(int)>& fn) {
+	num_threads = std::max(1, std::min(num_threads, n));
+
+	std::atomic<int> next{0};
+	auto worker = [&]() {
+		for (int i = next.fetch_add(1); i < n; i = next.fetch_add(1)) {
+			fn(i);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	for (int i = 1; i < num_threads; i++) {
+		pool.emplace_back(worker);
+	}
+	worker();
+
+	for (auto& thread : pool) {
+		thread.join();
+	}
+}
+
+TileReport parallel_for_tiles(const std::vector<Tile>& tiles, int num_threads,
+                              const std::function<void(const Tile&, int)>& task) {
+	int n_tiles = int(tiles.size());
+	num_threads = std::max(1, std::min(num_threads, n_tiles));
+
+	TileReport report;
+	report.tiles.resize(n_tiles, TileCost{0.0, -1, false});
+	report.busy_per_thread.assign(num_threads, 0.0);
+
+	// Répartition initiale en blocs contigus afin que chaque fil travaille sur une région compacte.
+	std::vector<TileDeque> queues(num_threads);
+	for (int itile = 0; itile < n_tiles; itile++) {
+		queues[int((long long)itile * num_threads / std::max(n_tiles, 1))].push_back(itile);
+	}
+
+	std::atomic<int> completed{0};
+	std::mutex progress_mutex;
+
+	auto worker = [&](int ithread) {
+		while (true) {
+			int itile;
+			bool stolen = false;
+
+			if (!queues[ithread].pop_front(itile)) {
+				// Aucune tuile ne s'ajoute en cours de route: si toutes les files sont vides, le travail est terminé.
+				bool found = false;
+				for (int i = 1; i < num_threads && !found; i++) {
+					found = queues[(ithread + i) % num_threads].steal_back(itile);
+				}
+				if (!found) {
+					break;
+				}
+				stolen = true;
+			}
+
+			Clock::time_point start = Clock::now();
+			task(tiles[itile], itile);
+			double cost = elapsed_ms(start, Clock::now());
+
+			report.tiles[itile] = TileCost{cost, ithread, stolen};
+			report.busy_per_thread[ithread] += cost;
+
+			int done = completed.fetch_add(1) + 1;
+			std::lock_guard<std::mutex> lock(progress_mutex);
+			std::cout << "\rTiles completed: " << done << "/" << n_tiles << std::flush;
+		}
+	};
+
+	Clock::time_point start = Clock::now();
+
+	// Le fil appelant participe également au rendu.
+	std::vector<std::thread> pool;
+	for (int i = 1; i < num_threads; i++) {
+		pool.emplace_back(worker, i);
+	}
+	worker(0);
+
+	for (auto& thread : pool) {
+		thread.join();
+	}
+	std::cout << std::endl;
+
+	report.wall_milliseconds = elapsed_ms(start, Clock::now());
+	return report;
+}
+
+void TileReport::print(std::ostream& out, const std::vector<Tile>& tile_list, int n_worst) const {
+	if (tiles.empty()) {
+		return;
+	}
+
+	double total = std::accumulate(busy_per_thread.begin(), busy_per_thread.end(), 0.0);
+	double busiest = *std::max_element(busy_per_thread.begin(), busy_per_thread.end());
+	double mean_tile = total / tiles.size();
+	int n_stolen = int(std::count_if(tiles.begin(), tiles.end(), [](const TileCost& c) { return c.stolen; }));
+
+	out << "Tiles: " << tiles.size() << " on " << busy_per_thread.size() << " threads, "
+	    << wall_milliseconds << " ms wall, " << n_stolen << " stolen" << std::endl;
+	out << "  Thread utilization: " << (wall_milliseconds > 0 ? 100.0 * total / (wall_milliseconds * busy_per_thread.size()) : 100.0)
+	    << "%, busiest thread / mean: " << (total > 0 ? busiest * busy_per_thread.size() / total : 1.0) << std::endl;
+
+	// Les tuiles les plus coûteuses indiquent où se trouve le déséquilibre.
+	std::vector<int> order(tiles.size());
+	std::iota(order.begin(), order.end(), 0);
+	n_worst = std::min(n_worst, int(order.size()));
+	std::partial_sort(order.begin(), order.begin() + n_worst, order.end(),
+	                  [&](int a, int b) { return tiles[a].milliseconds > tiles[b].milliseconds; });
+
+	for (int i = 0; i < n_worst; i++) {
+		const Tile& tile = tile_list[order[i]];
+		const TileCost& cost = tiles[order[i]];
+		out << "  Tile [" << tile.x_begin << "," << tile.x_end << ")x[" << tile.y_begin << "," << tile.y_end << "): "
+		    << cost.milliseconds << " ms (" << (mean_tile > 0 ? cost.milliseconds / mean_tile : 1.0) << "x mean)"
+		    << ", thread " << cost.thread << (cost.stolen ? ", stolen" : "") << std::endl;
+	}
+}
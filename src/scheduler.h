@@ -0,0 +1,59 @@
+#pragma once
+
+#include <functional>
+#include <iostream>
+#include <vector>
+
+// Une tuile rectangulaire de l'image [x_begin, x_end) x [y_begin, y_end).
+// Les coordonnées suivent celles de Raytracer::render (y = 0 est la première ligne traitée).
+struct Tile {
+    int x_begin, y_begin;
+    int x_end, y_end;
+};
+
+// Coût mesuré pour le rendu d'une tuile.
+struct TileCost {
+    // Temps de rendu de la tuile en millisecondes.
+    double milliseconds;
+    // Fil qui a rendu la tuile.
+    int thread;
+    // Vrai si la tuile a été volée dans la file d'un autre fil.
+    bool stolen;
+};
+
+// Rapport d'exécution de parallel_for_tiles.
+struct TileReport {
+    // Coût de chaque tuile, indexé comme la liste de tuiles.
+    std::vector<TileCost> tiles;
+
+    // Temps total passé à rendre des tuiles pour chaque fil (ms).
+    std::vector<double> busy_per_thread;
+
+    // Temps écoulé entre le début et la fin du rendu (ms).
+    double wall_milliseconds;
+
+    // Écrit un résumé du déséquilibre de charge ainsi que les tuiles les plus coûteuses.
+    void print(std::ostream& out, const std::vector<Tile>& tile_list, int n_worst = 5) const;
+};
+
+// Découpe une image de width x height pixels en tuiles d'au plus tile_size x tile_size.
+// Les tuiles sont ordonnées ligne par ligne, de gauche à droite.
+std::vector<Tile> split_into_tiles(int width, int height, int tile_size);
+
+// Retourne le nombre de fils à utiliser. Une valeur <= 0 correspond au nombre de coeurs de la machine.
+int resolve_thread_count(int requested);
+
+// Exécute task(tile, tile_index) pour chaque tuile sur un bassin de num_threads fils.
+//
+// Les tuiles sont d'abord réparties en blocs contigus dans une file (deque) par fil.
+// Chaque fil consomme sa file par l'avant; lorsqu'elle est vide, il vole des tuiles
+// à l'arrière de la file des autres fils. Les tuiles coûteuses (réflexion, réfraction)
+// ne laissent donc pas de coeurs inactifs à la fin de l'image.
+//
+// Chaque tuile est traitée par exactement un fil; la fonction retourne lorsque toutes les tuiles sont rendues.
+TileReport parallel_for_tiles(const std::vector<Tile>& tiles, int num_threads,
+                              const std::function<void(const Tile&, int)>& task);
+
+// Exécute fn(i) pour chaque i dans [0, n) sur un bassin de num_threads fils (le fil appelant inclus).
+// Les indices sont distribués dynamiquement; la fonction retourne lorsque tous les appels sont terminés.
+void parallel_for(int n, int num_threads, const std::function<void(int)>& fn);
@@ -0,0 +1,96 @@
+#pragma once
+
+// À n'inclure que dans les noyaux compilés avec AVX2 (*_avx2.cpp): les fonctions ci-dessous
+// utilisent des instructions AVX2 et ne doivent pas être compilées dans le reste du programme.
+//
+// Opérations vectorielles nommées selon le type scalaire, afin qu'un noyau écrit une seule fois
+// (template sur ces structures) soit compilé en float ou en double selon real (constants.h).
+
+#include <immintrin.h>
+
+// Registre AVX complet: 8 float ou 4 double.
+template <typename T>
+struct Avx2;
+
+template <>
+struct Avx2<float> {
+    typedef __m256 V;
+    static const int lanes = 8;
+
+    static V set1(float a) { return _mm256_set1_ps(a); }
+    static V zero() { return _mm256_setzero_ps(); }
+    static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    static V bit_and(V a, V b) { return _mm256_and_ps(a, b); }
+    static V bit_andnot(V a, V b) { return _mm256_andnot_ps(a, b); }
+    template <int Predicate>
+    static V cmp(V a, V b) { return _mm256_cmp_ps(a, b, Predicate); }
+    static int movemask(V a) { return _mm256_movemask_ps(a); }
+    static V load(const float* p) { return _mm256_load_ps(p); }
+    static void store(float* p, V a) { _mm256_store_ps(p, a); }
+    static void storeu(float* p, V a) { _mm256_storeu_ps(p, a); }
+
+    // Masque des voies [0, remaining) (toutes si remaining >= lanes), pour maskload.
+    static __m256i lane_mask(int remaining) {
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+    static V mask_to_v(__m256i mask) { return _mm256_castsi256_ps(mask); }
+    static V maskload(const float* p, __m256i mask) { return _mm256_maskload_ps(p, mask); }
+};
+
+template <>
+struct Avx2<double> {
+    typedef __m256d V;
+    static const int lanes = 4;
+
+    static V set1(double a) { return _mm256_set1_pd(a); }
+    static V zero() { return _mm256_setzero_pd(); }
+    static V add(V a, V b) { return _mm256_add_pd(a, b); }
+    static V sub(V a, V b) { return _mm256_sub_pd(a, b); }
+    static V mul(V a, V b) { return _mm256_mul_pd(a, b); }
+    static V div(V a, V b) { return _mm256_div_pd(a, b); }
+    static V min(V a, V b) { return _mm256_min_pd(a, b); }
+    static V max(V a, V b) { return _mm256_max_pd(a, b); }
+    static V bit_and(V a, V b) { return _mm256_and_pd(a, b); }
+    static V bit_andnot(V a, V b) { return _mm256_andnot_pd(a, b); }
+    template <int Predicate>
+    static V cmp(V a, V b) { return _mm256_cmp_pd(a, b, Predicate); }
+    static int movemask(V a) { return _mm256_movemask_pd(a); }
+    static V load(const double* p) { return _mm256_load_pd(p); }
+    static void store(double* p, V a) { _mm256_store_pd(p, a); }
+    static void storeu(double* p, V a) { _mm256_storeu_pd(p, a); }
+
+    static __m256i lane_mask(int remaining) {
+        return _mm256_cmpgt_epi64(_mm256_set1_epi64x(remaining), _mm256_setr_epi64x(0, 1, 2, 3));
+    }
+    static V mask_to_v(__m256i mask) { return _mm256_castsi256_pd(mask); }
+    static V maskload(const double* p, __m256i mask) { return _mm256_maskload_pd(p, mask); }
+};
+
+// Exactement 4 voies: un registre SSE de 4 float, ou un registre AVX de 4 double.
+template <typename T>
+struct Simd4;
+
+template <>
+struct Simd4<float> {
+    typedef __m128 V;
+    static const int lanes = 4;
+
+    static V set1(float a) { return _mm_set1_ps(a); }
+    static V sub(V a, V b) { return _mm_sub_ps(a, b); }
+    static V mul(V a, V b) { return _mm_mul_ps(a, b); }
+    static V min(V a, V b) { return _mm_min_ps(a, b); }
+    static V max(V a, V b) { return _mm_max_ps(a, b); }
+    template <int Predicate>
+    static V cmp(V a, V b) { return _mm_cmp_ps(a, b, Predicate); }
+    static int movemask(V a) { return _mm_movemask_ps(a); }
+    static V load(const float* p) { return _mm_load_ps(p); }
+    static void storeu(float* p, V a) { _mm_storeu_ps(p, a); }
+};
+
+template <>
+struct Simd4<double> : Avx2<double> {};
@@ -0,0 +1,83 @@
+#include "texture.h"
+
+#include <algorithm>
+#include <cmath>
+
+Texture::Texture(const bitmap_image& image) {
+	int width = std::max(int(image.width()), 1);
+	int height = std::max(int(image.height()), 1);
+	add_level(width, height);
+	for (int y = 0; y < int(image.height()); y++) {
+		for (int x = 0; x < int(image.width()); x++) {
+			unsigned char r, g, b;
+			image.get_pixel(x, y, r, g, b);
+			texels[texel_index(0, x, y)] = float3{r / 255.0f, g / 255.0f, b / 255.0f};
+		}
+	}
+	if (image.width() == 0 || image.height() == 0) {
+		// Image absente ou illisible: texture noire de 1x1.
+		texels[texel_index(0, 0, 0)] = float3{0, 0, 0};
+	}
+
+	// Chaque niveau est la moyenne des blocs de 2x2 texels du précédent. Une dimension impaire n donne
+	// (n + 1) / 2 texels: le dernier bloc ne couvre que le dernier texel, qui est alors compté deux fois.
+	// Ainsi, chaque texel du niveau précédent contribue au suivant.
+	while (width > 1 || height > 1) {
+		int parent = n_levels() - 1;
+		int level = add_level((width + 1) / 2, (height + 1) / 2);
+		for (int y = 0; y < levels[level].height; y++) {
+			int y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+			for (int x = 0; x < levels[level].width; x++) {
+				int x0 = std::min(2 * x, width - 1), x1 = std::min(2 * x + 1, width - 1);
+				texels[texel_index(level, x, y)] = (texel(parent, x0, y0) + texel(parent, x1, y0)
+				                    + texel(parent, x0, y1) + texel(parent, x1, y1)) * 0.25f;
+			}
+		}
+		width = levels[level].width;
+		height = levels[level].height;
+	}
+}
+
+int Texture::add_level(int width, int height) {
+	Level level;
+	level.width = width;
+	level.height = height;
+	level.tiles_x = (width + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE;
+	level.offset = texels.size();
+	int tiles_y = (height + TEXTURE_TILE_SIZE - 1) / TEXTURE_TILE_SIZE;
+	texels.resize(level.offset + size_t(level.tiles_x) * tiles_y * TEXTURE_TILE_SIZE * TEXTURE_TILE_SIZE);
+	levels.push_back(level);
+	return n_levels() - 1;
+}
+
+double3 Texture::sample_bilinear(double2 uv, int level) const {
+	level = std::min(std::max(level, 0), n_levels() - 1);
+	const Level& l = levels[level];
+
+	// Centre des texels en (i + 0.5) / width; v = 0 correspond à la dernière ligne de l'image.
+	double x = std::min(std::max(uv.x, 0.0), 1.0) * l.width - 0.5;
+	double y = (1.0 - std::min(std::max(uv.y, 0.0), 1.0)) * l.height - 0.5;
+	double fx = std::floor(x), fy = std::floor(y);
+	double tx = x - fx, ty = y - fy;
+	int x0 = std::max(int(fx), 0), y0 = std::max(int(fy), 0);
+	int x1 = std::min(int(fx) + 1, l.width - 1), y1 = std::min(int(fy) + 1, l.height - 1);
+
+	double3 top = lerp(double3(texel(level, x0, y0)), double3(texel(level, x1, y0)), tx);
+	double3 bottom = lerp(double3(texel(level, x0, y1)), double3(texel(level, x1, y1)), tx);
+	return lerp(top, bottom, ty);
+}
+
+double3 Texture::sample_trilinear(double2 uv, double footprint) const {
+	// Niveau de détail: log2 du nombre de texels de l'image d'origine couverts par l'empreinte.
+	double lod = std::log2(std::max(footprint * std::max(width(), height()), 1.0));
+	if (lod >= n_levels() - 1) {
+		return sample_bilinear(uv, n_levels() - 1);
+	}
+
+	int level = int(lod);
+	double t = lod - level;
+	if (t == 0) {
+		return sample_bilinear(uv, level);
+	}
+	return lerp(sample_bilinear(uv, level), sample_bilinear(uv, level + 1), t);
+}
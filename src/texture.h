@@ -0,0 +1,68 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+#include "basic.h"
+#include "bitmap_image/bitmap_image.h"
+#include "linalg/linalg.h"
+using namespace linalg::aliases;
+
+// Côté (en texels) d'une tuile d'un niveau de texture.
+#define TEXTURE_TILE_SIZE 8
+
+// Texture convertie au chargement en texels float normalisés [r,g,b \in 0..=1], avec sa chaîne de mipmaps.
+//
+// Chaque niveau est découpé en tuiles de TEXTURE_TILE_SIZE x TEXTURE_TILE_SIZE texels, rangées ligne par ligne,
+// et les texels d'une tuile sont contigus: les 4 texels d'une interpolation bilinéaire sont presque toujours
+// dans la même tuile (768 octets), plutôt que sur deux lignes éloignées de l'image.
+// Les coordonnées uv sont exprimées avec l'origine au coin inférieur gauche de l'image, comme Frame,
+// et sont ramenées dans [0, 1] (clamp) lors de l'échantillonnage.
+class Texture {
+public:
+    // Un niveau de la chaîne de mipmaps. Ses texels commencent à texels[offset].
+    struct Level {
+        int width;
+        int height;
+        int tiles_x;
+        size_t offset;
+    };
+
+    // Niveaux du plus détaillé (l'image d'origine) au plus grossier (1x1).
+    std::vector<Level> levels;
+
+    // Texels de tous les niveaux, tuile par tuile.
+    std::vector<float3> texels;
+
+    // Convertit l'image et construit ses mipmaps (moyenne de 2x2 texels par niveau).
+    Texture(const bitmap_image& image);
+
+    int width() const { return levels[0].width; }
+    int height() const { return levels[0].height; }
+    int n_levels() const { return int(levels.size()); }
+
+    // Mémoire occupée par les texels, mipmaps compris.
+    size_t memory_bytes() const { return texels.size() * sizeof(float3); }
+
+    // Index dans texels du texel (x, y) du niveau level, y = 0 étant la première ligne de l'image (en haut).
+    size_t texel_index(int level, int x, int y) const {
+        const Level& l = levels[level];
+        size_t tile = size_t(y / TEXTURE_TILE_SIZE) * l.tiles_x + x / TEXTURE_TILE_SIZE;
+        return l.offset + tile * TEXTURE_TILE_SIZE * TEXTURE_TILE_SIZE
+               + (y % TEXTURE_TILE_SIZE) * TEXTURE_TILE_SIZE + x % TEXTURE_TILE_SIZE;
+    }
+
+    const float3& texel(int level, int x, int y) const { return texels[texel_index(level, x, y)]; }
+
+    // Interpolation bilinéaire du niveau level à la coordonnée uv.
+    double3 sample_bilinear(double2 uv, int level) const;
+
+    // Interpolation trilinéaire selon l'empreinte du rayon: footprint est la largeur, en coordonnées uv,
+    // de la surface couverte par le rayon au point d'intersection (e.g. un pixel projeté sur l'objet).
+    // Une empreinte de 1 / width() ou moins échantillonne l'image d'origine.
+    double3 sample_trilinear(double2 uv, double footprint) const;
+
+private:
+    // Ajoute un niveau de width x height texels (nuls) et retourne son index.
+    int add_level(int width, int height);
+};
@@ -0,0 +1,59 @@
+#include "triangle_store.h"
+#include "cpu.h"
+
+void TriangleStore::push_back(real3 a, real3 b, real3 c) {
+	real3 edge1 = b - a;
+	real3 edge2 = c - a;
+	real3 normal = cross(edge1, edge2);
+
+	for (int axis = 0; axis < 3; axis++) {
+		p0[axis].push_back(a[axis]);
+		e1[axis].push_back(edge1[axis]);
+		e2[axis].push_back(edge2[axis]);
+		n[axis].push_back(normal[axis]);
+	}
+}
+
+namespace {
+
+typedef int (*IntersectRange)(const TriangleStore&, int, int, const Ray&, real, real*);
+
+// Repli scalaire: un triangle à la fois.
+int intersect_range_scalar(const TriangleStore& store, int begin, int end, const Ray& ray, real t_min, real* t_max) {
+	int closest = -1;
+	for (int i = begin; i < end; i++) {
+		real t;
+		if (store.intersect(i, ray, t_min, *t_max, &t)) {
+			*t_max = t;
+			closest = i;
+		}
+	}
+	return closest;
+}
+
+#if defined(RAY_HAS_AVX2_KERNELS)
+int intersect_range_avx2(const TriangleStore& store, int begin, int end, const Ray& ray, real t_min, real* t_max) {
+	const real* p0[3] = {store.p0[0].data(), store.p0[1].data(), store.p0[2].data()};
+	const real* e1[3] = {store.e1[0].data(), store.e1[1].data(), store.e1[2].data()};
+	const real* e2[3] = {store.e2[0].data(), store.e2[1].data(), store.e2[2].data()};
+	const real origin[3] = {ray.origin.x, ray.origin.y, ray.origin.z};
+	const real direction[3] = {ray.direction.x, ray.direction.y, ray.direction.z};
+	return triangle_intersect_avx2(p0, e1, e2, origin, direction, begin, end, t_min, t_max);
+}
+#endif
+
+IntersectRange select_kernel() {
+#if defined(RAY_HAS_AVX2_KERNELS)
+	if (cpu_has_avx2()) {
+		return intersect_range_avx2;
+	}
+#endif
+	return intersect_range_scalar;
+}
+
+}
+
+int TriangleStore::intersect_range(int begin, int end, const Ray& ray, real t_min, real* t_max) const {
+	static const IntersectRange kernel = select_kernel();
+	return kernel(*this, begin, end, ray, t_min, t_max);
+}
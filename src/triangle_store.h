@@ -0,0 +1,80 @@
+#pragma once
+
+#include <vector>
+
+#include "basic.h"
+#include "linalg/linalg.h"
+using namespace linalg::aliases;
+
+// Triangles prétraités pour l'intersection Möller–Trumbore.
+//
+// Chaque triangle (p0, p1, p2) est stocké sous la forme du sommet p0, des arêtes e1 = p1 - p0
+// et e2 = p2 - p0 ainsi que de la normale géométrique n = e1 x e2 (non normalisée, même
+// orientation que Mesh::intersect_triangle). Les composantes sont rangées en structure de
+// tableaux (SoA): les triangles consécutifs d'une feuille du BVH sont contigus pour chaque
+// composante, ce qui permet de les charger plusieurs à la fois.
+class TriangleStore {
+public:
+    // Composantes x, y, z de p0, e1, e2 et n, indexées par triangle.
+    std::vector<real> p0[3];
+    std::vector<real> e1[3];
+    std::vector<real> e2[3];
+    std::vector<real> n[3];
+
+    // Nombre de triangles.
+    int size() const { return int(p0[0].size()); }
+
+    // Ajoute le triangle (a, b, c).
+    void push_back(real3 a, real3 b, real3 c);
+
+    // Normale géométrique (non normalisée) du triangle i.
+    real3 normal(int i) const { return real3{n[0][i], n[1][i], n[2][i]}; }
+
+    // Intersection Möller–Trumbore du rayon avec le triangle i.
+    // Retourne vrai si le rayon touche le triangle à une profondeur t dans ]t_min, t_max[.
+    bool intersect(int i, const Ray& ray, real t_min, real t_max, real* t) const {
+        real3 edge1{e1[0][i], e1[1][i], e1[2][i]};
+        real3 edge2{e2[0][i], e2[1][i], e2[2][i]};
+
+        // det = e1 . (d x e2) = -n . d: le rayon est parallèle au plan si det est nul.
+        real3 pvec = cross(ray.direction, edge2);
+        real det = dot(edge1, pvec);
+        if (fabs(det) < real(EPSILON)) {
+            return false;
+        }
+        real inv_det = real(1) / det;
+
+        // Coordonnées barycentriques (u, v) du point d'intersection.
+        real3 tvec = ray.origin - real3{p0[0][i], p0[1][i], p0[2][i]};
+        real u = dot(tvec, pvec) * inv_det;
+        if (u < 0 || u > 1) {
+            return false;
+        }
+
+        real3 qvec = cross(tvec, edge1);
+        real v = dot(ray.direction, qvec) * inv_det;
+        if (v < 0 || u + v > 1) {
+            return false;
+        }
+
+        real depth = dot(edge2, qvec) * inv_det;
+        if (depth <= t_min || depth >= t_max) {
+            return false;
+        }
+
+        *t = depth;
+        return true;
+    }
+
+    // Intersection Möller–Trumbore du rayon avec les triangles [begin, end).
+    // Retourne l'index du triangle le plus proche touché dans ]t_min, *t_max[ et réduit *t_max
+    // à sa profondeur, ou -1 s'il n'y en a aucun. Utilise le noyau AVX2 (4 triangles à la fois)
+    // si le processeur le supporte; le résultat est identique à celui de intersect.
+    int intersect_range(int begin, int end, const Ray& ray, real t_min, real* t_max) const;
+};
+
+// Noyau AVX2 (triangle_store_avx2.cpp): même calcul que TriangleStore::intersect sur les triangles
+// [begin, end), 4 à la fois. p0, e1 et e2 pointent sur les composantes x, y, z de TriangleStore.
+int triangle_intersect_avx2(const real* const p0[3], const real* const e1[3], const real* const e2[3],
+                            const real origin[3], const real direction[3],
+                            int begin, int end, real t_min, real* t_max);
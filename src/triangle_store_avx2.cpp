@@ -0,0 +1,109 @@
+// Compilé avec AVX2 (voir CMakeLists.txt). N'est appelé que si cpu_has_avx2() est vrai.
+//
+// Comme sampler_avx2.cpp, ce fichier n'inclut que des en-têtes sans fonction partagée avec le reste
+// du programme: constants.h (type real et constantes) et simd_avx2.h (réservé aux noyaux AVX2).
+//
+// Les opérations sont effectuées dans le même ordre que TriangleStore::intersect (sans FMA),
+// les profondeurs obtenues sont donc identiques au bit près.
+
+#include "constants.h"
+#include "simd_avx2.h"
+
+namespace {
+
+// a x b, composante par composante.
+template <typename S>
+inline void cross(typename S::V ax, typename S::V ay, typename S::V az,
+                  typename S::V bx, typename S::V by, typename S::V bz,
+                  typename S::V& cx, typename S::V& cy, typename S::V& cz) {
+	cx = S::sub(S::mul(ay, bz), S::mul(az, by));
+	cy = S::sub(S::mul(az, bx), S::mul(ax, bz));
+	cz = S::sub(S::mul(ax, by), S::mul(ay, bx));
+}
+
+template <typename S>
+inline typename S::V dot(typename S::V ax, typename S::V ay, typename S::V az,
+                         typename S::V bx, typename S::V by, typename S::V bz) {
+	return S::add(S::add(S::mul(ax, bx), S::mul(ay, by)), S::mul(az, bz));
+}
+
+// Möller–Trumbore sur S::lanes triangles à la fois (8 en float, 4 en double).
+template <typename S>
+int intersect_range(const real* const p0[3], const real* const e1[3], const real* const e2[3],
+                    const real origin[3], const real direction[3],
+                    int begin, int end, real t_min, real* t_max) {
+	typedef typename S::V V;
+
+	const V ox = S::set1(origin[0]), oy = S::set1(origin[1]), oz = S::set1(origin[2]);
+	const V dx = S::set1(direction[0]), dy = S::set1(direction[1]), dz = S::set1(direction[2]);
+	const V zero = S::zero();
+	const V one = S::set1(real(1));
+	const V epsilon = S::set1(real(EPSILON));
+	const V sign_mask = S::set1(real(-0.0));
+	const V tmin = S::set1(t_min);
+
+	int closest = -1;
+	for (int i = begin; i < end; i += S::lanes) {
+		// Les voies au-delà de end ne sont pas lues.
+		__m256i lanes = S::lane_mask(end - i);
+
+		V e1x = S::maskload(e1[0] + i, lanes);
+		V e1y = S::maskload(e1[1] + i, lanes);
+		V e1z = S::maskload(e1[2] + i, lanes);
+		V e2x = S::maskload(e2[0] + i, lanes);
+		V e2y = S::maskload(e2[1] + i, lanes);
+		V e2z = S::maskload(e2[2] + i, lanes);
+
+		// det = e1 . (d x e2)
+		V px, py, pz;
+		cross<S>(dx, dy, dz, e2x, e2y, e2z, px, py, pz);
+		V det = dot<S>(e1x, e1y, e1z, px, py, pz);
+		V valid = S::bit_and(S::mask_to_v(lanes), S::template cmp<_CMP_GE_OQ>(S::bit_andnot(sign_mask, det), epsilon));
+		if (S::movemask(valid) == 0) {
+			continue;
+		}
+		V inv_det = S::div(one, det);
+
+		V tx = S::sub(ox, S::maskload(p0[0] + i, lanes));
+		V ty = S::sub(oy, S::maskload(p0[1] + i, lanes));
+		V tz = S::sub(oz, S::maskload(p0[2] + i, lanes));
+		V u = S::mul(dot<S>(tx, ty, tz, px, py, pz), inv_det);
+		valid = S::bit_and(valid, S::bit_and(S::template cmp<_CMP_GE_OQ>(u, zero), S::template cmp<_CMP_LE_OQ>(u, one)));
+
+		V qx, qy, qz;
+		cross<S>(tx, ty, tz, e1x, e1y, e1z, qx, qy, qz);
+		V v = S::mul(dot<S>(dx, dy, dz, qx, qy, qz), inv_det);
+		valid = S::bit_and(valid, S::bit_and(S::template cmp<_CMP_GE_OQ>(v, zero),
+			S::template cmp<_CMP_LE_OQ>(S::add(u, v), one)));
+
+		V t = S::mul(dot<S>(e2x, e2y, e2z, qx, qy, qz), inv_det);
+		valid = S::bit_and(valid, S::bit_and(S::template cmp<_CMP_GT_OQ>(t, tmin),
+			S::template cmp<_CMP_LT_OQ>(t, S::set1(*t_max))));
+
+		int mask = S::movemask(valid);
+		if (mask == 0) {
+			continue;
+		}
+
+		// Plus proche intersection parmi les voies valides; à égalité, le premier triangle l'emporte
+		// comme dans la boucle scalaire.
+		alignas(32) real depths[S::lanes];
+		S::store(depths, t);
+		for (int lane = 0; lane < S::lanes; lane++) {
+			if ((mask & (1 << lane)) && depths[lane] < *t_max) {
+				*t_max = depths[lane];
+				closest = i + lane;
+			}
+		}
+	}
+
+	return closest;
+}
+
+}
+
+int triangle_intersect_avx2(const real* const p0[3], const real* const e1[3], const real* const e2[3],
+                            const real origin[3], const real direction[3],
+                            int begin, int end, real t_min, real* t_max) {
+	return intersect_range<Avx2<real>>(p0, e1, e2, origin, direction, begin, end, t_min, t_max);
+}